@@ -0,0 +1,91 @@
+/*
+ * homework.h
+ *
+ * Desc: Every homework pattern, each in its own namespace. Shared by the
+ * demo (main.cpp), the tests and the benchmarks.
+ */
+
+#ifndef HOMEWORK_H_
+#define HOMEWORK_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <new>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+#ifdef __SSE2__
+#include <immintrin.h>  // The factory method's ChaCha kernels.
+#endif
+
+#include "macros.h"  // there can be only one
+#include "sink.h"
+#include "parallel.h"
+
+namespace homework {
+
+namespace strategy {
+#include "problem/strategy.h"
+#include "solution/strategy.h"
+}
+
+namespace adapter {
+#include "problem/adapter.h"
+#include "solution/adapter.h"
+}
+
+namespace factoryMethod {
+#include "problem/factoryMethod.h"
+#include "solution/factoryMethod.h"
+}
+
+namespace templateMethod {
+#include "problem/templateMethod.h"
+#include "solution/templateMethod.h"
+}
+
+namespace observer {
+#include "problem/observer.h"
+#include "solution/observer.h"
+}
+
+namespace decorator {
+#include "problem/decorator.h"
+#include "solution/decorator.h"
+}
+
+namespace chainOfResponsibility {
+#include "problem/chainOfResp.h"
+#include "solution/chainOfResp.h"
+}
+
+namespace bridge {
+#include "problem/bridge.h"
+//#include "solution/bridge.h"
+}
+
+namespace abstractFactory {
+#include "problem/abstractFactory.h"
+//#include "solution/bridge.h"
+}
+
+// Seam point - include next design pattern.
+}
+
+#endif /* HOMEWORK_H_ */
@@ -11,7 +11,7 @@
 const unsigned flags = 0x0E;  // Dtor instrumentation controlled by bit flags.
 #define DTOR(x, flag) \
   if (flag & flags) { \
-    cout << x;        \
+    out() << x;       \
   }
 
 enum DtorFlags {
@@ -1,75 +1,69 @@
-#include <cstdio>
-#include <cstdlib>
-#include <cstring>
+#include "homework.h"
 
-#include <list>
-#include <map>
-#include <set>
-#include <vector>
-
-#include <iostream>
-using namespace std;
-
-#include "macros.h"  // there can be only one
-
-namespace homework {
-
-namespace strategy {
-#include "problem/strategy.h"
-#include "solution/strategy.h"
-}
-
-namespace adapter {
-#include "problem/adapter.h"
-#include "solution/adapter.h"
-}
-
-namespace factoryMethod {
-#include "problem/factoryMethod.h"
-#include "solution/factoryMethod.h"
-}
-
-namespace templateMethod {
-#include "problem/templateMethod.h"
-#include "solution/templateMethod.h"
-}
-
-namespace observer {
-#include "problem/observer.h"
-#include "solution/observer.h"
-}
-
-namespace decorator {
-#include "problem/decorator.h"
-#include "solution/decorator.h"
-}
-
-namespace chainOfResponsibility {
-#include "problem/chainOfResp.h"
-#include "solution/chainOfResp.h"
-}
-
-namespace bridge {
-#include "problem/bridge.h"
-//#include "solution/bridge.h"
-}
-
-namespace abstractFactory {
-#include "problem/abstractFactory.h"
-//#include "solution/bridge.h"
-}
-
-// Seam point - include next design pattern.
+static bool parseMode(const char* mode, int* res, int* fps) {  // WxH@FPS
+  return sscanf(mode, "%dx%d@%d", &res[0], &res[1], fps) == 3 && res[0] > 0 &&
+         res[1] > 0 && *fps > 0;
 }
 
 int main(int argc, char* args[]) {
-  if (argc != 2) {
-    printf("Usage: ./a.out <dp-number> (1-9)\n");
+  if (argc < 2) {
+    printf("Usage: ./a.out <dp-number> (1-9) [--profile]"
+           " [--profile-every=N] [--profile-json=FILE]"
+           " [--pipeline[=WxH@FPS]] [--streams[=WxH@FPS]]\n");
     exit(-1);
   }
 
   int dp = atoi(args[1]);
 
+  // Strategy dispatch profiling (dp 1), reported once the demos finish:
+  // as text on stdout, and/or as JSON to a file of its own.
+  bool profile = false;
+  unsigned long profileEvery = 1;
+  const char* profileJson = 0;
+
+  // Real frames through every display x crypto pair (dp 3), timed.
+  bool pipeline = false;
+  int pipelineRes[2] = {1920, 1080};
+  int pipelineFps = 60;
+
+  // Every display x crypto pair as a paced stream at once (dp 3).
+  bool streams = false;
+  int streamRes[2] = {320, 240};
+  int streamFps = 30;
+
+  for (int i = 2; i < argc; i++) {
+    const char* option = args[i];
+    if (!strcmp(option, "--profile")) {
+      profile = true;
+    } else if (!strncmp(option, "--profile-every=", 16)) {
+      profileEvery = strtoul(option + 16, 0, 10);
+    } else if (!strncmp(option, "--profile-json=", 15)) {
+      profileJson = option + 15;
+    } else if (!strcmp(option, "--pipeline")) {
+      pipeline = true;
+    } else if (!strncmp(option, "--pipeline=", 11)) {
+      pipeline = parseMode(option + 11, pipelineRes, &pipelineFps);
+      if (!pipeline) {
+        printf("Bad %s, want --pipeline=WxH@FPS.\n", option);
+        exit(-1);
+      }
+    } else if (!strcmp(option, "--streams")) {
+      streams = true;
+    } else if (!strncmp(option, "--streams=", 10)) {
+      streams = parseMode(option + 10, streamRes, &streamFps);
+      if (!streams) {
+        printf("Bad %s, want --streams=WxH@FPS.\n", option);
+        exit(-1);
+      }
+    } else {
+      printf("Unknown option %s.\n", option);
+      exit(-1);
+    }
+  }
+  if (profile || profileJson) {
+    homework::strategy::solution::profiler().enable(profileEvery);
+  }
+
   switch (dp) {
     case 1:
       homework::strategy::legacy::demo(dp);
@@ -124,5 +118,33 @@ int main(int argc, char* args[]) {
       break;
   }
 
+  if (pipeline) {
+    cout << "Frame pipeline at " << pipelineFps << " frames/sec:\n";
+    homework::factoryMethod::solution::pipelineReport(cout, pipelineFps,
+                                                      pipelineRes, 10);
+  }
+  if (streams) {
+    using namespace homework::factoryMethod::solution;
+    StreamEngine engine;
+    for (size_t i = 0; i < COUNT(displayCatalog); i++) {
+      for (size_t j = 0; j < COUNT(cryptoCatalog); j++) {
+        StreamConfig stream = {displayCatalog[i].make(),
+                               cryptoCatalog[j].make(), streamFps,
+                               {streamRes[0], streamRes[1]}};
+        engine.add(stream);
+      }
+    }
+    WorkStealingPool pool;
+    engine.run(2 * streamFps, pool, true);  // Two seconds, late frames shed.
+    cout << "Paced streams:\n";
+    engine.report(cout);
+  }
+  if (profile) homework::strategy::solution::profiler().report(cout);
+  if (profileJson) {
+    ofstream json(profileJson);
+    homework::strategy::solution::profiler().json(json);
+    if (!json) printf("Could not write %s.\n", profileJson);
+  }
+
   printf("Done.\n");
 }
@@ -0,0 +1,186 @@
+/*
+ * parallel.h
+ *
+ * Desc: Work-stealing fan-out of independent tasks, with the output of each
+ * task collected and replayed in task order so logs stay reproducible.
+ */
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sink.h"
+
+/* Each worker owns a range of task indices and takes from its front. A
+ * worker that runs dry steals the back half of another worker's range.
+ * The workers are started once and park between runs; the caller of run()
+ * takes part as worker 0. Runs from different threads take turns.
+ */
+class WorkStealingPool {
+  struct Range {
+    mutex lock;
+    size_t next;
+    size_t end;
+  };
+
+  unsigned workers;
+  vector<thread> threads;
+  mutex runLock;  // One run at a time.
+
+  mutex lock;  // Guards the job below.
+  condition_variable wake;
+  condition_variable done;
+  unsigned long generation;  // Bumped per run; workers wait for a change.
+  size_t active;             // Workers taking part in this run.
+  size_t busy;               // Of those, still working.
+  bool quit;
+  vector<Range>* ranges;
+  void (*invoke)(void*, size_t);
+  void* task;
+
+ public:
+  explicit WorkStealingPool(unsigned workers = 0)
+      : workers(workers ? workers : thread::hardware_concurrency()),
+        generation(0), active(0), busy(0), quit(false), ranges(0), invoke(0),
+        task(0) {
+    if (!this->workers) this->workers = 1;
+    for (size_t w = 1; w < this->workers; w++) {
+      threads.push_back(thread(&WorkStealingPool::serve, this, w));
+    }
+  }
+  ~WorkStealingPool() {
+    {
+      lock_guard<mutex> guard(lock);
+      quit = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+  }
+
+ public:
+  unsigned size() const {
+    return workers;
+  }
+
+  template <class Task>  // Called as task(i) for every i in [0, count).
+  void run(size_t count, Task task) {
+    lock_guard<mutex> serial(runLock);
+    size_t n = (count < workers) ? (count ? count : 1) : workers;
+    vector<Range> ranges(n);
+    for (size_t w = 0; w < n; w++) {
+      ranges[w].next = count * w / n;
+      ranges[w].end = count * (w + 1) / n;
+    }
+
+    {
+      lock_guard<mutex> guard(lock);
+      this->ranges = &ranges;
+      this->invoke = &WorkStealingPool::call<Task>;
+      this->task = &task;
+      active = n;
+      busy = n - 1;
+      generation++;
+    }
+    if (n > 1) wake.notify_all();
+    work(&ranges, 0, invoke, &task);
+
+    unique_lock<mutex> guard(lock);
+    while (busy) done.wait(guard);
+  }
+
+  template <class Task>  // Output of each task is replayed in task order.
+  void runOrdered(size_t count, Task task, ostream& to = out()) {
+    vector<string> outputs(count);
+    run(count, Ordered<Task>(task, outputs));
+    for (size_t i = 0; i < count; i++) to << outputs[i];
+  }
+
+ private:
+  template <class Task>
+  struct Ordered {
+    Task& task;
+    vector<string>& outputs;
+
+    Ordered(Task& task, vector<string>& outputs)
+        : task(task), outputs(outputs) {
+    }
+    void operator()(size_t i) {
+      ostringstream captured;
+      {
+        Redirect redirect(captured);
+        task(i);
+      }
+      outputs[i] = captured.str();
+    }
+  };
+
+  static bool take(Range& range, size_t& i) {
+    lock_guard<mutex> guard(range.lock);
+    if (range.next == range.end) return false;
+    i = range.next++;
+    return true;
+  }
+
+  static bool steal(vector<Range>* ranges, size_t self) {
+    Range& mine = (*ranges)[self];
+    for (size_t k = 1; k < ranges->size(); k++) {
+      Range& victim = (*ranges)[(self + k) % ranges->size()];
+      size_t from, to;
+      {
+        lock_guard<mutex> guard(victim.lock);
+        size_t left = victim.end - victim.next;
+        if (!left) continue;
+        from = victim.end - (left + 1) / 2;
+        to = victim.end;
+        victim.end = from;
+      }
+      lock_guard<mutex> guard(mine.lock);
+      mine.next = from;
+      mine.end = to;
+      return true;
+    }
+    return false;
+  }
+
+  template <class Task>
+  static void call(void* task, size_t i) {
+    (*static_cast<Task*>(task))(i);
+  }
+
+  static void work(vector<Range>* ranges, size_t self,
+                   void (*invoke)(void*, size_t), void* task) {
+    size_t i;
+    do {
+      while (take((*ranges)[self], i)) invoke(task, i);
+    } while (steal(ranges, self));
+  }
+
+  void serve(size_t self) {  // Worker thread: park, work, report, repeat.
+    unsigned long seen = 0;
+    unique_lock<mutex> guard(lock);
+    for (;;) {
+      while (!quit && (generation == seen || self >= active)) {
+        seen = generation;
+        wake.wait(guard);
+      }
+      if (quit) return;
+      seen = generation;
+      vector<Range>* ranges = this->ranges;
+      void (*invoke)(void*, size_t) = this->invoke;
+      void* task = this->task;
+      guard.unlock();
+      work(ranges, self, invoke, task);
+      guard.lock();
+      if (--busy == 0) done.notify_one();
+    }
+  }
+};
+
+#endif /* PARALLEL_H_ */
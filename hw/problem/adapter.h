@@ -55,7 +55,7 @@ class Point : public ShapeInterfaceDraw {
 
  public:
   void draw() {
-    cout << "  Draw point.\n";
+    out() << "  Draw point.\n";
   }
 };
 
@@ -67,7 +67,7 @@ class Line : public ShapeInterfaceDraw {
 
  public:
   void draw() {
-    cout << "  Draw line.\n";
+    out() << "  Draw line.\n";
   }
 };
 
@@ -79,7 +79,7 @@ class Rect : public ShapeInterfaceDraw {
 
  public:
   void draw() {
-    cout << "  Draw rectangle.\n";
+    out() << "  Draw rectangle.\n";
   }
 };
 
@@ -94,7 +94,7 @@ void clientCode(ShapeInterfaceDraw* shape) {  // Interface adapts to Client.
 }
 
 void demo(int seqNo) {
-  cout << seqNo << ") << adapter::homework::legacy::demo() >>\n";
+  out() << seqNo << ") << adapter::homework::legacy::demo() >>\n";
   vector<ShapeInterfaceDraw*> shapes;
   shapes.push_back(new Point);
   shapes.push_back(new Line);
@@ -104,7 +104,7 @@ void demo(int seqNo) {
     clientCode(shapes[i]);
   }
   for (size_t i = 0; i < shapes.size(); i++) delete shapes[i];
-  cout << endl;
+  out() << endl;
 }
 
 }  // legacy
@@ -129,7 +129,7 @@ class Polygon : public ShapeInterfaceDisplay {
 
  public:
   void display() {
-    cout << "  Display polygon.\n";
+    out() << "  Display polygon.\n";
   }
 };
 
@@ -141,7 +141,7 @@ class Torus : public ShapeInterfaceDisplay {
 
  public:
   void display() {
-    cout << "  Display torus.\n";
+    out() << "  Display torus.\n";
   }
 };
 
@@ -153,7 +153,7 @@ class Bezel : public ShapeInterfaceDisplay {
 
  public:
   void display() {
-    cout << "  Display bezel.\n";
+    out() << "  Display bezel.\n";
   }
 };
 
@@ -172,7 +172,7 @@ struct Polygon : public ShapeInterfaceDraw {
   }
 
   void draw() {
-    cout << "  Adaptor ::";
+    out() << "  Adaptor ::";
     polygon.display();
   }
 };
@@ -186,7 +186,7 @@ struct Torus : public ShapeInterfaceDraw {
   }
 
   void draw() {
-    cout << "  Adaptor ::";
+    out() << "  Adaptor ::";
     torus.display();
   }
 };
@@ -200,7 +200,7 @@ struct Bezel : public ShapeInterfaceDraw {
   }
 
   void draw() {
-    cout << "  Adaptor ::";
+    out() << "  Adaptor ::";
     bezel.display();
   }
 };
@@ -210,7 +210,7 @@ void clientCode(ShapeInterfaceDraw* shape) {
 }
 
 void demo(int seqNo) {
-  cout << seqNo << ") << adapter::homework::problem::demo() >>\n";
+  out() << seqNo << ") << adapter::homework::problem::demo() >>\n";
   vector<ShapeInterfaceDraw*> shapes;
   shapes.push_back(new Point);
   shapes.push_back(new Line);
@@ -227,7 +227,7 @@ void demo(int seqNo) {
     delete shapes[i];
   }
 
-  cout << endl;
+  out() << endl;
 }
 
 }  // problem
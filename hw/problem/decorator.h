@@ -87,13 +87,13 @@ void demo(int /* seqNo */) {
   Car* cars[] = {new RunAbout, new SUV};
 
   for (size_t i = 0; i < COUNT(cars); i++) {
-    cout << "  " << cars[i]->getDesc();
-    cout << " costs $" << cars[i]->getCost() << ".\n";
+    out() << "  " << cars[i]->getDesc();
+    out() << " costs $" << cars[i]->getCost() << ".\n";
   }
-  cout << endl;
+  out() << endl;
 
   for (size_t i = 0; i < COUNT(cars); i++) delete cars[i];
-  cout << endl;
+  out() << endl;
 }
 
 }  // legacy
@@ -309,15 +309,15 @@ void demo(int /* seqNo */) {
   Car* cars[] = {mine, yours, hers, boss};
 
   for (size_t i = 0; i < COUNT(cars); i++) {
-    cout << "  " << cars[i]->getDesc();
-    cout << " costs $" << cars[i]->getCost() << ".\n";
+    out() << "  " << cars[i]->getDesc();
+    out() << " costs $" << cars[i]->getCost() << ".\n";
   }
-  cout << endl;
+  out() << endl;
 
   for (size_t i = 0; i < COUNT(cars); i++) {
     delete cars[i];
   }
-  cout << endl;
+  out() << endl;
 }
 
 }  // problem
@@ -46,7 +46,7 @@ class Thing {
 
  public:
   void obeys() {
-    cout << "    Thing " << name << " makes mischief.\n";
+    out() << "    Thing " << name << " makes mischief.\n";
   }
 };
 
@@ -63,7 +63,7 @@ class Child {
 
  public:
   void giggles() {
-    cout << "    " << name << " laughs.\n";
+    out() << "    " << name << " laughs.\n";
   }
 };
 
@@ -94,7 +94,7 @@ class Perpetrator {
 
  public:
   void says(const string& phrase) {
-    cout << "  " << name << " says " << phrase << ".\n";
+    out() << "  " << name << " says " << phrase << ".\n";
     if (thing1) thing1->obeys();
     if (thing2) thing2->obeys();
     if (boy) boy->giggles();
@@ -104,7 +104,7 @@ class Perpetrator {
 };
 
 void demo(int seqNo) {
-  cout << seqNo << ") << observer::homework::legacy::demo() >>\n";
+  out() << seqNo << ") << observer::homework::legacy::demo() >>\n";
   {
     Perpetrator perp("Cat in the Hat");
 
@@ -134,7 +134,7 @@ void demo(int seqNo) {
     delete boy;
     delete girl;
   }
-  cout << endl;
+  out() << endl;
 }
 
 }  // legacy
@@ -189,7 +189,7 @@ struct Listener {
 };
 
 void Perpetrator::says(const string& phrase) {
-  cout << "  " << name << " says " << phrase << ".\n";
+  out() << "  " << name << " says " << phrase << ".\n";
   list<Listener*>::iterator it = listeners.begin();
   for (; it != listeners.end(); ++it) {
     (*it)->update(this);
@@ -206,7 +206,7 @@ struct Thing : public Listener {
   }
 
   void update(Perpetrator*) {
-    cout << "    Thing " << name << " makes mischief.\n";
+    out() << "    Thing " << name << " makes mischief.\n";
   }
 };
 
@@ -219,7 +219,7 @@ struct Child : public Listener {
   }
 
   void update(Perpetrator*) {
-    cout << "    " << name << " laughs.\n";
+    out() << "    " << name << " laughs.\n";
   }
 };
 
@@ -232,7 +232,7 @@ struct Fish : public Listener {
   }
 
   void update(Perpetrator*) {
-    cout << "    " << name << " complains.\n";
+    out() << "    " << name << " complains.\n";
   }
 };
 
@@ -245,14 +245,14 @@ struct Mom : public Listener {
   }
 
   void update(Perpetrator*) {
-    cout << "    " << name << " asks \"How was your day?\"\n";
+    out() << "    " << name << " asks \"How was your day?\"\n";
   }
 };
 
 // Seam point - add another listener.
 
 void demo(int seqNo) {
-  cout << seqNo << ") << observer::homework::problem::demo() >>\n";
+  out() << seqNo << ") << observer::homework::problem::demo() >>\n";
   {
     Perpetrator perpetrator("Cat in the Hat");
 
@@ -298,7 +298,7 @@ void demo(int seqNo) {
     delete fish;
     delete mom;
   }
-  cout << endl;
+  out() << endl;
 }
 
 }  // problem
@@ -57,7 +57,7 @@ struct CriteriaHard : public Strategy {
   }
 
   void compute() {
-    cout << "The hard way.\n";
+    out() << "The hard way.\n";
   }
 };
 
@@ -67,7 +67,7 @@ struct CriteriaEasy : public Strategy {
   }
 
   void compute() {
-    cout << "The easy way.\n";
+    out() << "The easy way.\n";
   }
 };
 
@@ -77,33 +77,33 @@ struct CriteriaTrivial : public Strategy {
   }
 
   void compute() {
-    cout << "The trivial way.\n";
+    out() << "The trivial way.\n";
   }
 };
 
 void clientCode1(Strategy* criteria) {
-  cout << "  clientCode1 - ";
+  out() << "  clientCode1 - ";
   criteria->compute();
 }
 
 void clientCode2(Strategy* criteria) {
-  cout << "  clientCode2 - ";
+  out() << "  clientCode2 - ";
   criteria->compute();
 }
 
 void clientCode3(Strategy* criteria) {
-  cout << "  clientCode3 - ";
+  out() << "  clientCode3 - ";
   criteria->compute();
 }
 
 //...
 void clientCode8(Strategy* criteria) {
-  cout << "  clientCode8 - ";
+  out() << "  clientCode8 - ";
   criteria->compute();
 }
 
 void demo(int seqNo) {  // Test all daughter classes & clients.
-  cout << seqNo << ") << strategy::homework::problem::demo() >>\n";
+  out() << seqNo << ") << strategy::homework::problem::demo() >>\n";
   Way criteria[] = {Hard, Easy, Trivial};
   Strategy* scheme[COUNT(criteria)] = {0};
 
@@ -127,9 +127,9 @@ void demo(int seqNo) {  // Test all daughter classes & clients.
     clientCode3(scheme[i]);
     //...
     clientCode8(scheme[i]);
-    cout << endl;
+    out() << "\n";
   }
-  cout << endl;
+  out() << endl;
 
   for (size_t i = 0; i < COUNT(criteria); i++) {
     delete scheme[i];
@@ -165,7 +165,7 @@ struct CriteriaHard : Strategy {
   }
 
   void compute() {
-    cout << "The hard way.\n";
+    out() << "The hard way.\n";
   }
 };
 
@@ -175,7 +175,7 @@ struct CriteriaEasy : Strategy {
   }
 
   void compute() {
-    cout << "The easy way.\n";
+    out() << "The easy way.\n";
   }
 };
 
@@ -185,7 +185,7 @@ struct CriteriaQuick : Strategy {
   }
 
   void compute() {
-    cout << "The quick way.\n";
+    out() << "The quick way.\n";
   }
 };
 
@@ -195,7 +195,7 @@ struct CriteriaClear : Strategy {
   }
 
   void compute() {
-    cout << "The clear way.\n";
+    out() << "The clear way.\n";
   }
 };
 
@@ -205,34 +205,34 @@ struct CriteriaGiven : Strategy {
   }
 
   void compute() {
-    cout << "The given way.\n";
+    out() << "The given way.\n";
   }
 };
 
 void clientCode1(Strategy* criteria) {
-  cout << "  clientCode1 - ";
+  out() << "  clientCode1 - ";
   criteria->compute();
 }
 
 void clientCode2(Strategy* criteria) {
-  cout << "  clientCode2 - ";
+  out() << "  clientCode2 - ";
   criteria->compute();
 }
 
 void clientCode3(Strategy* criteria) {
-  cout << "  clientCode3 - ";
+  out() << "  clientCode3 - ";
   criteria->compute();
 }
 
 //...
 
 void clientCode18(Strategy* criteria) {
-  cout << "  clientCode18 - ";
+  out() << "  clientCode18 - ";
   criteria->compute();
 }
 
 void demo(int seqNo) {  // Test all daughter classes & clients.
-  cout << seqNo << ") << strategy::homework::problem::demo() >>\n";
+  out() << seqNo << ") << strategy::homework::problem::demo() >>\n";
   Way criteria[] = {Hard, Easy, Quick, Clear, Given};
   Strategy* scheme[COUNT(criteria)] = {0};
 
@@ -264,9 +264,9 @@ void demo(int seqNo) {  // Test all daughter classes & clients.
     clientCode3(scheme[i]);
     //...
     clientCode18(scheme[i]);
-    cout << endl;
+    out() << "\n";
   }
-  cout << endl;
+  out() << endl;
 
   for (size_t i = 0; i < COUNT(criteria); i++) {
     delete scheme[i];
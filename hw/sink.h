@@ -0,0 +1,92 @@
+/*
+ * sink.h
+ *
+ * Desc: Pluggable output sink for the demos. Pattern code writes to out(),
+ * which is cout unless the current thread has been redirected, for
+ * instance to a buffered sink or to a null sink when benchmarking.
+ */
+
+#ifndef SINK_H_
+#define SINK_H_
+
+#include <streambuf>
+#include <vector>
+
+inline ostream*& currentOut() {
+  static thread_local ostream* current = 0;
+  return current;
+}
+inline ostream& out() {
+  ostream* current = currentOut();
+  return current ? *current : cout;
+}
+
+class Redirect {  // Send this thread's out() to another stream for a scope.
+  ostream* saved;
+
+ public:
+  explicit Redirect(ostream& to) : saved(currentOut()) {
+    currentOut() = &to;
+  }
+  ~Redirect() {
+    currentOut() = saved;
+  }
+};
+
+/* Collects output in a large buffer and passes it on only when the buffer
+ * fills or the stream is flushed (endl, flush()), i.e. at batch boundaries.
+ * Give each thread its own, via Redirect.
+ */
+class BufferedSink : public streambuf {
+  streambuf* target;
+  vector<char> buffer;
+
+ public:
+  explicit BufferedSink(streambuf* target = cout.rdbuf(),
+                        size_t threshold = 64 * 1024)
+      : target(target), buffer(threshold ? threshold : 1) {
+    setp(&buffer[0], &buffer[0] + buffer.size());
+  }
+  ~BufferedSink() {
+    sync();
+  }
+
+ protected:
+  int_type overflow(int_type c) {
+    if (drain() != 0) return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+  int sync() {
+    if (drain() != 0) return -1;
+    return target->pubsync();
+  }
+
+ private:
+  int drain() {
+    streamsize pending = pptr() - pbase();
+    if (pending && target->sputn(pbase(), pending) != pending) return -1;
+    setp(&buffer[0], &buffer[0] + buffer.size());
+    return 0;
+  }
+};
+
+class NullSink : public streambuf {  // Discards everything.
+  char scratch[256];
+
+ public:
+  NullSink() {
+    setp(scratch, scratch + sizeof(scratch));
+  }
+
+ protected:
+  int_type overflow(int_type c) {
+    setp(scratch, scratch + sizeof(scratch));
+    return traits_type::not_eof(c);
+  }
+};
+
+#endif /* SINK_H_ */
@@ -37,6 +37,150 @@
 
 namespace solution {
 
+/* Draw commands. A shape's draw()/display() emits one of these; unless the
+ * thread has a RenderQueue installed it is formatted and written at once.
+ */
+enum DrawCommand {
+  DrawPoint,
+  DrawLine,
+  DrawRect,
+  DisplayPolygon,
+  DisplayTorus,
+  DisplayBezel,
+  // Seam point - add another shape.
+};
+
+const char* const drawText[] = {
+    "  Draw point.\n",      "  Draw line.\n",     "  Draw rectangle.\n",
+    "  Display polygon.\n", "  Display torus.\n", "  Display bezel.\n",
+};
+
+/* Single-producer/single-consumer ring of one-byte draw commands, drained
+ * by a background thread that does the formatting and I/O. When the ring
+ * is full the producer either waits (Block) or counts a drop (Drop). The
+ * ring itself is lock-free; the mutex is taken only to park an idle
+ * consumer or a blocked producer and to wake it, so an idle queue costs no
+ * CPU. The consumer checks back a few times before parking, which spares a
+ * busy producer most wakeups.
+ */
+class RenderQueue {
+ public:
+  enum Backpressure { Block, Drop };
+
+ private:
+  vector<uint8_t> ring;
+  size_t mask;
+  Backpressure policy;
+  atomic<size_t> head;  // Next slot to write; producer only.
+  atomic<size_t> tail;  // Next slot to read; consumer only.
+  atomic<unsigned long> dropped;
+  atomic<unsigned long> drained;
+  atomic<bool> stopping;
+  mutex lock;  // For parking only.
+  condition_variable consumerWake;
+  condition_variable producerWake;
+  atomic<bool> consumerParked;
+  atomic<bool> producerParked;
+  ostream& to;
+  thread consumer;
+
+ public:
+  explicit RenderQueue(size_t capacity = 4096, Backpressure policy = Block,
+                       ostream& to = cout)
+      : policy(policy), head(0), tail(0), dropped(0), drained(0),
+        stopping(false), consumerParked(false), producerParked(false),
+        to(to) {
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+    ring.resize(size);
+    mask = size - 1;
+    consumer = thread(&RenderQueue::drain, this);
+  }
+  ~RenderQueue() {  // Drains whatever is left before returning.
+    {
+      lock_guard<mutex> guard(lock);
+      stopping.store(true);
+    }
+    consumerWake.notify_one();
+    consumer.join();
+  }
+
+ public:
+  bool push(DrawCommand command) {
+    size_t h = head.load(memory_order_relaxed);
+    if (h - tail.load(memory_order_acquire) > mask) {
+      if (policy == Drop) {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return false;
+      }
+      unique_lock<mutex> guard(lock);
+      producerParked.store(true);
+      while (h - tail.load() > mask) producerWake.wait(guard);
+      producerParked.store(false);
+    }
+    ring[h & mask] = uint8_t(command);
+    head.store(h + 1);  // Ordered before the check of consumerParked.
+    if (consumerParked.load()) {
+      lock_guard<mutex> guard(lock);
+      consumerWake.notify_one();
+    }
+    return true;
+  }
+
+  size_t capacity() const {
+    return ring.size();
+  }
+  size_t pending() const {
+    return head.load(memory_order_acquire) - tail.load(memory_order_acquire);
+  }
+  unsigned long drops() const {
+    return dropped.load(memory_order_relaxed);
+  }
+  unsigned long written() const {
+    return drained.load(memory_order_relaxed);
+  }
+
+ private:
+  void drain() {
+    for (;;) {
+      bool last = stopping.load();
+      size_t t = tail.load(memory_order_relaxed);
+      size_t h = head.load(memory_order_acquire);
+      for (; t != h; t++) to << drawText[ring[t & mask]];
+      tail.store(t);  // Ordered before the check of producerParked.
+      drained.store(t, memory_order_relaxed);
+      if (producerParked.load()) {
+        lock_guard<mutex> guard(lock);
+        producerWake.notify_one();
+      }
+      if (last) break;
+      for (int spin = 0; spin < 64 && t == head.load(); spin++) {
+        this_thread::yield();
+      }
+      if (t != head.load()) continue;
+
+      unique_lock<mutex> guard(lock);
+      consumerParked.store(true);
+      while (t == head.load() && !stopping.load()) consumerWake.wait(guard);
+      consumerParked.store(false);
+    }
+    to.flush();
+  }
+};
+
+inline RenderQueue*& renderQueue() {  // Queue for this thread's draws.
+  static thread_local RenderQueue* queue = 0;
+  return queue;
+}
+
+void emit(DrawCommand command) {
+  RenderQueue* queue = renderQueue();
+  if (queue)
+    queue->push(command);
+  else
+    out() << drawText[command];
+}
+
 namespace home_grown {
 
 class ShapeInterfaceDraw {  // Home grown interface class.
@@ -56,7 +200,7 @@ class Point : public ShapeInterfaceDraw {
 
  public:
   void draw() {
-    cout << "  Draw point.\n";
+    emit(DrawPoint);
   }
 };
 class Line : public ShapeInterfaceDraw {
@@ -67,7 +211,7 @@ class Line : public ShapeInterfaceDraw {
 
  public:
   void draw() {
-    cout << "  Draw line.\n";
+    emit(DrawLine);
   }
 };
 class Rect : public ShapeInterfaceDraw {
@@ -78,7 +222,7 @@ class Rect : public ShapeInterfaceDraw {
 
  public:
   void draw() {
-    cout << "  Draw rectangle.\n";
+    emit(DrawRect);
   }
 };
 
@@ -103,7 +247,7 @@ class Polygon : public ShapeInterfaceDisplay {
 
  public:
   void display() {
-    cout << "  Display polygon.\n";
+    emit(DisplayPolygon);
   }
 };
 class Torus : public ShapeInterfaceDisplay {
@@ -114,7 +258,7 @@ class Torus : public ShapeInterfaceDisplay {
 
  public:
   void display() {
-    cout << "  Display torus.\n";
+    emit(DisplayTorus);
   }
 };
 class Bezel : public ShapeInterfaceDisplay {
@@ -125,7 +269,7 @@ class Bezel : public ShapeInterfaceDisplay {
 
  public:
   void display() {
-    cout << "  Display bezel.\n";
+    emit(DisplayBezel);
   }
 };
 
@@ -171,12 +315,330 @@ class Bezel : public ShapeInterfaceDraw {
 };
 // Seam point - add another interface.
 
+/* One adapter for any class with display(). Being final, a call through a
+ * DisplayAdapter<T> of known type binds statically and can be inlined.
+ */
+template <class Commercial>
+class DisplayAdapter final : public ShapeInterfaceDraw {
+ public:
+  Commercial adaptee;
+
+ public:
+  void draw() {
+    adaptee.display();
+  }
+};
+
+/* A vector of commercial shapes seen as home grown ones, without building
+ * a wrapper per element. at(i) re-points a single adapter owned by the view,
+ * so the pointer it returns is only good until the next at().
+ */
+class DisplayView {
+  class Cursor final : public ShapeInterfaceDraw {
+   public:
+    commercial::ShapeInterfaceDisplay* shape;
+
+   public:
+    void draw() {
+      shape->display();
+    }
+  };
+
+  const vector<commercial::ShapeInterfaceDisplay*>& shapes;
+  Cursor cursor;
+
+ public:
+  explicit DisplayView(const vector<commercial::ShapeInterfaceDisplay*>& shapes)
+      : shapes(shapes) {
+    cursor.shape = 0;
+  }
+
+ public:
+  size_t size() const {
+    return shapes.size();
+  }
+  ShapeInterfaceDraw* at(size_t i) {
+    cursor.shape = shapes[i];
+    return &cursor;
+  }
+  void drawAll() {
+    for (size_t i = 0; i < shapes.size(); i++) shapes[i]->display();
+  }
+};
+
 void clientCode(ShapeInterfaceDraw* shape) {  // Interface adapts to Client.
   shape->draw();
 }
 
+/* Type-erased value holding any shape with draw() or display() inline, so
+ * neither a heap allocation nor a hand-written adapter is needed. Build in
+ * place with ShapeRef(ShapeRef::Make<Torus>()) or copy from an existing
+ * shape; shapes larger than the inline buffer do not compile.
+ */
+class ShapeRef {
+  struct Ops {
+    void (*draw)(void*);
+    void (*copy)(void*, const void*);
+    void (*destroy)(void*);
+  };
+
+  template <class Shape>
+  struct OpsFor {
+    static void draw(void* shape) {
+      render(*static_cast<Shape*>(shape), 0);
+    }
+    static void copy(void* to, const void* from) {
+      new (to) Shape(*static_cast<const Shape*>(from));
+    }
+    static void destroy(void* shape) {
+      static_cast<Shape*>(shape)->~Shape();
+    }
+    static const Ops ops;
+  };
+
+  template <class Shape>  // Preferred: home grown.
+  static auto render(Shape& shape, int) -> decltype(shape.draw(), void()) {
+    shape.draw();
+  }
+  template <class Shape>  // Otherwise commercial.
+  static auto render(Shape& shape, long) -> decltype(shape.display(), void()) {
+    shape.display();
+  }
+
+  static const size_t Capacity = 2 * sizeof(void*);
+  typename aligned_storage<Capacity>::type storage;
+  const Ops* ops;
+
+ public:
+  template <class Shape>
+  struct Make {};
+
+  template <class Shape>
+  ShapeRef(Make<Shape>) : ops(&OpsFor<Shape>::ops) {
+    static_assert(sizeof(Shape) <= Capacity, "shape too big for ShapeRef");
+    new (&storage) Shape;
+  }
+  template <class Shape>
+  ShapeRef(const Shape& shape) : ops(&OpsFor<Shape>::ops) {
+    static_assert(sizeof(Shape) <= Capacity, "shape too big for ShapeRef");
+    new (&storage) Shape(shape);
+  }
+  ShapeRef(const ShapeRef& other) : ops(other.ops) {
+    ops->copy(&storage, &other.storage);
+  }
+  ShapeRef& operator=(const ShapeRef& other) {
+    if (this != &other) {
+      ops->destroy(&storage);
+      ops = other.ops;
+      ops->copy(&storage, &other.storage);
+    }
+    return *this;
+  }
+  ~ShapeRef() {
+    ops->destroy(&storage);
+  }
+
+ public:
+  void draw() {
+    ops->draw(&storage);
+  }
+};
+
+template <class Shape>
+const ShapeRef::Ops ShapeRef::OpsFor<Shape>::ops = {
+    &ShapeRef::OpsFor<Shape>::draw, &ShapeRef::OpsFor<Shape>::copy,
+    &ShapeRef::OpsFor<Shape>::destroy,
+};
+
+/* Shapes kept by concrete type, each type in its own contiguous array.
+ * drawAll() walks each array with statically bound calls, no virtual
+ * dispatch; pointers() still hands out the polymorphic interface.
+ */
+class ShapeStore {
+  vector<Point> points;
+  vector<Line> lines;
+  vector<Rect> rects;
+  vector<Polygon> polygons;
+  vector<Torus> tori;
+  vector<Bezel> bezels;
+  // Seam point - add another shape.
+
+  vector<Point>& column(Point*) {
+    return points;
+  }
+  vector<Line>& column(Line*) {
+    return lines;
+  }
+  vector<Rect>& column(Rect*) {
+    return rects;
+  }
+  vector<Polygon>& column(Polygon*) {
+    return polygons;
+  }
+  vector<Torus>& column(Torus*) {
+    return tori;
+  }
+  vector<Bezel>& column(Bezel*) {
+    return bezels;
+  }
+
+  template <class Shape>
+  static void drawEach(vector<Shape>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) shapes[i].Shape::draw();
+  }
+  template <class Shape>
+  static void collect(vector<Shape>& shapes, vector<ShapeInterfaceDraw*>& to) {
+    for (size_t i = 0; i < shapes.size(); i++) to.push_back(&shapes[i]);
+  }
+
+ public:
+  template <class Shape>  // Built in place, grouped with its own type.
+  void add(size_t count = 1) {
+    vector<Shape>& shapes = column(static_cast<Shape*>(0));
+    shapes.resize(shapes.size() + count);
+  }
+  template <class Shape>
+  void reserve(size_t count) {
+    column(static_cast<Shape*>(0)).reserve(count);
+  }
+
+  void drawAll() {
+    drawEach(points);
+    drawEach(lines);
+    drawEach(rects);
+    drawEach(polygons);
+    drawEach(tori);
+    drawEach(bezels);
+  }
+
+  size_t size() const {
+    return points.size() + lines.size() + rects.size() + polygons.size() +
+           tori.size() + bezels.size();
+  }
+  vector<ShapeInterfaceDraw*> pointers() {  // Valid until the next add().
+    vector<ShapeInterfaceDraw*> all;
+    all.reserve(size());
+    collect(points, all);
+    collect(lines, all);
+    collect(rects, all);
+    collect(polygons, all);
+    collect(tori, all);
+    collect(bezels, all);
+    return all;
+  }
+};
+
+/* Binary scene file: a 64 byte header followed by one 64 byte record per
+ * shape, a DrawCommand tag plus payload (unused by today's shapes, zero).
+ * loadScene() streams the records through a fixed chunk buffer counting
+ * tags, so its memory does not grow with the scene, then builds each
+ * ShapeStore array in a single step.
+ */
+struct SceneHeader {
+  char magic[8];  // "HWSCENE1"
+  uint64_t count;
+  uint8_t reserved[48];
+};
+
+struct SceneRecord {
+  uint32_t tag;  // DrawCommand.
+  uint8_t payload[60];
+};
+
+static_assert(sizeof(SceneHeader) == 64, "scene header must be 64 bytes");
+static_assert(sizeof(SceneRecord) == 64, "scene records must be 64 bytes");
+
+bool writeScene(const char* path, const DrawCommand* shapes, size_t count) {
+  FILE* file = fopen(path, "wb");
+  if (!file) return false;
+
+  SceneHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "HWSCENE1", sizeof(header.magic));
+  header.count = count;
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+  SceneRecord record;
+  memset(&record, 0, sizeof(record));
+  for (size_t i = 0; ok && i < count; i++) {
+    record.tag = shapes[i];
+    ok = fwrite(&record, sizeof(record), 1, file) == 1;
+  }
+  return (fclose(file) == 0) && ok;
+}
+
+bool loadScene(const char* path, ShapeStore& store) {
+  FILE* file = fopen(path, "rb");
+  if (!file) return false;
+
+  long size = -1;  // Trust the header's count only as far as the file goes.
+  if (!fseek(file, 0, SEEK_END)) size = ftell(file);
+  rewind(file);
+
+  SceneHeader header;
+  bool ok = size >= long(sizeof(header)) &&
+            fread(&header, sizeof(header), 1, file) == 1 &&
+            !memcmp(header.magic, "HWSCENE1", sizeof(header.magic)) &&
+            header.count <= (size - sizeof(header)) / sizeof(SceneRecord);
+
+  size_t counts[COUNT(drawText)] = {0};
+  SceneRecord chunk[256];
+  for (uint64_t left = ok ? header.count : 0; ok && left;) {
+    size_t n = size_t(min<uint64_t>(left, COUNT(chunk)));
+    ok = fread(chunk, sizeof(SceneRecord), n, file) == n;
+    for (size_t i = 0; ok && i < n; i++) {
+      ok = chunk[i].tag < COUNT(counts);
+      if (ok) counts[chunk[i].tag]++;
+    }
+    left -= n;
+  }
+  fclose(file);
+  if (!ok) return false;
+
+  store.add<Point>(counts[DrawPoint]);
+  store.add<Line>(counts[DrawLine]);
+  store.add<Rect>(counts[DrawRect]);
+  store.add<Polygon>(counts[DisplayPolygon]);
+  store.add<Torus>(counts[DisplayTorus]);
+  store.add<Bezel>(counts[DisplayBezel]);
+  // Seam point - add another shape.
+  return true;
+}
+
+/* Parallel draw: the shapes are split into chunks, each chunk is drawn on
+ * a pool thread into its own buffer, and the buffers are written out in
+ * original order, so the output matches drawing them one by one. A chunk
+ * bypasses any RenderQueue on its thread (the caller is one of the pool's
+ * workers), or its draws would miss the buffer.
+ */
+class DrawChunk {
+  const vector<ShapeInterfaceDraw*>& shapes;
+  size_t chunk;
+
+ public:
+  DrawChunk(const vector<ShapeInterfaceDraw*>& shapes, size_t chunk)
+      : shapes(shapes), chunk(chunk) {
+  }
+
+ public:
+  void operator()(size_t c) {
+    RenderQueue* queue = renderQueue();
+    renderQueue() = 0;
+    size_t end = min(shapes.size(), (c + 1) * chunk);
+    for (size_t i = c * chunk; i < end; i++) clientCode(shapes[i]);
+    renderQueue() = queue;
+  }
+};
+
+void drawParallel(const vector<ShapeInterfaceDraw*>& shapes,
+                  WorkStealingPool& pool, size_t chunk = 4096) {
+  if (!chunk) chunk = 1;
+  size_t chunks = (shapes.size() + chunk - 1) / chunk;
+  pool.runOrdered(chunks, DrawChunk(shapes, chunk), out());
+}
+
 void demo(int seqNo) {
-  cout << seqNo << ") << adapter::homework::solution::demo() >>\n";
+  out() << seqNo << ") << adapter::homework::solution::demo() >>\n";
   vector<ShapeInterfaceDraw*> shapes;  // Old client code stays the same.
   shapes.push_back(new Point);
   shapes.push_back(new Line);
@@ -189,7 +651,7 @@ void demo(int seqNo) {
     clientCode(shapes[i]);                      // because API's have
   }                                             // been converged.
   for (size_t i = 0; i < shapes.size(); i++) delete shapes[i];
-  cout << endl;
+  out() << endl;
 }
 
 }  // solution
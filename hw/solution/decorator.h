@@ -209,14 +209,14 @@ void demo(int /* seqNo */) {
   Car* cars[] = { mine, yours, hers, boss };
 
   for(size_t i=0; i<COUNT(cars); i++) {
-    cout << "  " << cars[i]->getDesc();
-    cout << " costs $" << cars[i]->getCost() << ".\n";
+    out() << "  " << cars[i]->getDesc();
+    out() << " costs $" << cars[i]->getCost() << ".\n";
   }
-  cout << endl;
+  out() << endl;
 
   for(size_t i=0; i<COUNT(cars); i++)
     delete cars[i];
-  cout << endl;
+  out() << endl;
 }
 
 } // solution
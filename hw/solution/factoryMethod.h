@@ -41,9 +41,200 @@ namespace solution {
  * and the new crypto protocol (RDX).
  */
 
-int framerate = 0;
+/* A synthetic video frame, 4 bytes (RGBA) per pixel, for running real
+ * frames through the display and crypto stages. The pixels belong to a
+ * FramePool; stages work on them in place. The display stage may pack the
+ * frame smaller; payload is what is left to encrypt and send.
+ */
+struct Frame {
+  int width;
+  int height;
+  unsigned long number;
+  uint8_t* pixels;
+  size_t payload;
+
+  size_t bytes() const {
+    return size_t(width) * height * 4;
+  }
+  void generate(unsigned long number) {  // Moving gradient test pattern.
+    this->number = number;
+    payload = bytes();
+    uint8_t* p = pixels;
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++, p += 4) {
+        p[0] = uint8_t(x + number);
+        p[1] = uint8_t(y + number);
+        p[2] = uint8_t(x ^ y);
+        p[3] = 0xFF;
+      }
+    }
+  }
+};
 
-int res[] = {0, 0};
+class FramePool;
+
+/* Reference-counted handle to a pooled frame. Copies share the frame, so a
+ * frame passes from stage to stage without copying its pixels; it goes
+ * back to the pool when the last handle lets go. Empty if the pool ran dry.
+ */
+class FrameRef {
+  FramePool* pool;
+  size_t slot;
+
+ public:
+  FrameRef() : pool(0), slot(0) {
+  }
+  FrameRef(FramePool* pool, size_t slot) : pool(pool), slot(slot) {
+  }
+  FrameRef(const FrameRef& other);
+  FrameRef& operator=(const FrameRef& other);
+  ~FrameRef();
+
+ public:
+  Frame& operator*() const;
+  Frame* operator->() const {
+    return &**this;
+  }
+  explicit operator bool() const {
+    return pool != 0;
+  }
+};
+
+/* A fixed number of frame buffers for one resolution, carved out of one
+ * allocation made up front. Each buffer starts on a cache line, and frames
+ * are recycled, so steady-state streaming allocates nothing.
+ */
+class FramePool {
+  static const size_t CacheLine = 64;
+
+  struct Slot {
+    Frame frame;
+    atomic<int> refs;
+  };
+
+  vector<uint8_t> storage;
+  vector<Slot> slots;
+  vector<size_t> available;  // Never grows past slots.size().
+  mutex lock;
+  atomic<unsigned long> handedOut;  // Read without the lock.
+
+  friend class FrameRef;
+
+  void retain(size_t slot) {
+    slots[slot].refs.fetch_add(1, memory_order_relaxed);
+  }
+  void release(size_t slot) {
+    if (slots[slot].refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+      lock_guard<mutex> guard(lock);
+      available.push_back(slot);
+    }
+  }
+
+ public:
+  FramePool(int width, int height, size_t count)
+      : slots(count), handedOut(0) {
+    size_t bytes = size_t(width) * height * 4;
+    size_t stride = (bytes + CacheLine - 1) / CacheLine * CacheLine;
+    storage.resize(stride * count + CacheLine);
+    uintptr_t base = reinterpret_cast<uintptr_t>(&storage[0]);
+    size_t skew = (CacheLine - base % CacheLine) % CacheLine;
+
+    available.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      Frame& frame = slots[i].frame;
+      frame.width = width;
+      frame.height = height;
+      frame.number = 0;
+      frame.pixels = &storage[skew + i * stride];
+      frame.payload = frame.bytes();
+      slots[i].refs = 0;
+      available.push_back(count - 1 - i);
+    }
+  }
+
+ public:
+  FrameRef acquire() {
+    lock_guard<mutex> guard(lock);
+    if (available.empty()) return FrameRef();
+    size_t slot = available.back();
+    available.pop_back();
+    slots[slot].refs.store(1, memory_order_relaxed);
+    handedOut.fetch_add(1, memory_order_relaxed);
+    return FrameRef(this, slot);
+  }
+
+  size_t capacity() const {
+    return slots.size();
+  }
+  unsigned long acquired() const {  // Frames handed out so far.
+    return handedOut.load(memory_order_relaxed);
+  }
+};
+
+inline FrameRef::FrameRef(const FrameRef& other)
+    : pool(other.pool), slot(other.slot) {
+  if (pool) pool->retain(slot);
+}
+inline FrameRef& FrameRef::operator=(const FrameRef& other) {
+  if (other.pool) other.pool->retain(other.slot);
+  if (pool) pool->release(slot);
+  pool = other.pool;
+  slot = other.slot;
+  return *this;
+}
+inline FrameRef::~FrameRef() {
+  if (pool) pool->release(slot);
+}
+inline Frame& FrameRef::operator*() const {
+  return pool->slots[slot].frame;
+}
+
+class Display;
+class Crypto;
+
+/* Everything that varies per stream, so streams can run side by side. */
+struct StreamConfig {
+  Display* display;
+  Crypto* crypto;
+  int framerate;
+  int res[2];
+};
+
+/* Factory catalogs: name and maker pairs kept sorted by name, so a lookup
+ * is a binary search over string compares and allocates nothing.
+ * Displays and cryptos are stateless, so each maker hands out one shared
+ * instance (a Flyweight) owned by the catalog; callers must not delete it.
+ * Each entry also carries the bandwidth its product can carry, which
+ * stream admission checks against.
+ */
+template <class Product>
+struct Catalog {
+  const char* name;
+  Product* (*make)();
+  double gbps;  // Display link budget, or crypto rate; 0 for no limit.
+};
+
+template <class Product>
+struct ByName {
+  bool operator()(const Catalog<Product>& entry, const char* name) const {
+    return strcmp(entry.name, name) < 0;
+  }
+};
+
+template <class Derived, class Product>
+Product* make() {
+  static Derived instance;
+  return &instance;
+}
+
+template <class Product>
+const Catalog<Product>* find(const Catalog<Product>* catalog, size_t count,
+                             const string& name) {
+  const Catalog<Product>* end = catalog + count;
+  const Catalog<Product>* entry =
+      lower_bound(catalog, end, name.c_str(), ByName<Product>());
+  return (entry != end && name == entry->name) ? entry : 0;
+}
 
 class Display {
  public:
@@ -52,9 +243,11 @@ class Display {
   }
 
  public:
-  virtual string format() {
+  virtual const char* format() {  // Interned; never freed.
     return "display-format()";
   }
+  virtual void pack(Frame&) {  // RGBA as generated.
+  }
 
  public:
   static Display* makeObject(const string& criteria);
@@ -66,9 +259,13 @@ class DisplayPort : public Display {
   }
 
  public:
-  virtual string format() {
+  virtual const char* format() {
     return "DisplayPort()";
   }
+  virtual void pack(Frame& frame) {  // BGRA.
+    uint8_t* p = frame.pixels;
+    for (size_t i = 0; i < frame.payload; i += 4) swap(p[i], p[i + 2]);
+  }
 };
 class HDMI : public Display {
  public:
@@ -77,9 +274,18 @@ class HDMI : public Display {
   }
 
  public:
-  virtual string format() {
+  virtual const char* format() {
     return "HDMI()";
   }
+  virtual void pack(Frame& frame) {  // YCbCr 4:4:4, BT.601 integer form.
+    uint8_t* p = frame.pixels;
+    for (size_t i = 0; i < frame.payload; i += 4) {
+      int r = p[i], g = p[i + 1], b = p[i + 2];
+      p[i] = uint8_t((66 * r + 129 * g + 25 * b + 128) / 256 + 16);
+      p[i + 1] = uint8_t((-38 * r - 74 * g + 112 * b + 128) / 256 + 128);
+      p[i + 2] = uint8_t((112 * r - 94 * g - 18 * b + 128) / 256 + 128);
+    }
+  }
 };
 class MIPI : public Display {
  public:
@@ -88,9 +294,20 @@ class MIPI : public Display {
   }
 
  public:
-  virtual string format() {
+  virtual const char* format() {
     return "MIPI()";
   }
+  virtual void pack(Frame& frame) {  // RGB565, two bytes per pixel.
+    uint8_t* p = frame.pixels;
+    size_t pixels = frame.payload / 4;
+    for (size_t i = 0; i < pixels; i++) {
+      const uint8_t* rgba = p + 4 * i;
+      uint16_t v = uint16_t((rgba[0] >> 3) << 11 | (rgba[1] >> 2) << 5 |
+                            rgba[2] >> 3);
+      p[2 * i] = uint8_t(v), p[2 * i + 1] = uint8_t(v >> 8);
+    }
+    frame.payload = 2 * pixels;
+  }
 };
 class Widi : public Display {
  public:
@@ -99,9 +316,19 @@ class Widi : public Display {
   }
 
  public:
-  virtual string format() {
+  virtual const char* format() {
     return "Widi()";
   }
+  virtual void pack(Frame& frame) {  // RGB888, alpha dropped.
+    uint8_t* p = frame.pixels;
+    size_t pixels = frame.payload / 4;
+    for (size_t i = 0; i < pixels; i++) {
+      p[3 * i] = p[4 * i];
+      p[3 * i + 1] = p[4 * i + 1];
+      p[3 * i + 2] = p[4 * i + 2];
+    }
+    frame.payload = 3 * pixels;
+  }
 };
 class HEVC : public Display {
  public:
@@ -110,27 +337,263 @@ class HEVC : public Display {
   }
 
  public:
-  virtual string format() {
+  virtual const char* format() {
     return "HEVC()";
   }
+  virtual void pack(Frame& frame) {  // Horizontal delta, ahead of coding.
+    uint8_t* p = frame.pixels;
+    size_t row = size_t(frame.width) * 4;
+    for (size_t y = 0; y + row <= frame.payload; y += row) {
+      for (size_t i = row - 1; i >= 4; i--) p[y + i] -= p[y + i - 4];
+    }
+  }
 };
 // Seam point - add another factory.
 
+const Catalog<Display> displayCatalog[] = {  // Sorted by name.
+    {"DisplayPort", make<DisplayPort, Display>, 25.92},
+    {"HDMI", make<HDMI, Display>, 14.4},
+    {"HEVC", make<HEVC, Display>, 48.0},
+    {"MIPI", make<MIPI, Display>, 18.0},
+    {"Widi", make<Widi, Display>, 7.0},
+    // Seam point - register another criteria, in order.
+};
+
 Display* Display::makeObject(const string& criteria) {
-  if (criteria == "DisplayPort")
-    return new DisplayPort;
-  else if (criteria == "HDMI")
-    return new HDMI;
-  else if (criteria == "MIPI")
-    return new MIPI;
-  else if (criteria == "Widi")
-    return new Widi;
-  else if (criteria == "HEVC")
-    return new HEVC;
-  // Seam point - insert another criteria.
-  return new Display;
+  const Catalog<Display>* entry =
+      find(displayCatalog, COUNT(displayCatalog), criteria);
+  return entry ? entry->make() : make<Display, Display>();
 }
 
+/* ChaCha stream cipher (the RFC 8439 block function, with a choice of
+ * rounds). block() is the scalar reference, one 64 byte block at a time.
+ * On x86 an SSE2 kernel runs four blocks side by side and an AVX2 kernel
+ * eight, each state word in one vector register across the blocks. The
+ * best kernel the CPU supports is picked once, on first use; bytes short
+ * of a whole pass of blocks go through the reference.
+ */
+#if defined(__SSE2__) && defined(__GNUC__)
+#define CHACHA_AVX2 __attribute__((target("avx2")))
+#endif
+
+class ChaCha {
+ public:
+  enum Kernel { Scalar, Sse2, Avx2, Kernels };  // Each implies the last.
+
+ private:
+  uint32_t key[8];
+  unsigned rounds;
+
+  static uint32_t rotl(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+  }
+  static void quarter(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d) {
+    a += b, d = rotl(d ^ a, 16);
+    c += d, b = rotl(b ^ c, 12);
+    a += b, d = rotl(d ^ a, 8);
+    c += d, b = rotl(b ^ c, 7);
+  }
+  template <class Word>  // Two rounds: a column and a diagonal round.
+  static void doubleRound(Word* x) {
+    quarter(x[0], x[4], x[8], x[12]), quarter(x[1], x[5], x[9], x[13]);
+    quarter(x[2], x[6], x[10], x[14]), quarter(x[3], x[7], x[11], x[15]);
+    quarter(x[0], x[5], x[10], x[15]), quarter(x[1], x[6], x[11], x[12]);
+    quarter(x[2], x[7], x[8], x[13]), quarter(x[3], x[4], x[9], x[14]);
+  }
+
+  /* XOR up to one block of keystream, then step the block counter. */
+  static void block(uint32_t* state, unsigned rounds, uint8_t* data,
+                    size_t size) {
+    uint32_t x[16];
+    memcpy(x, state, sizeof(x));
+    for (unsigned r = 0; r < rounds; r += 2) doubleRound(x);
+    uint8_t stream[64];
+    for (size_t w = 0; w < 16; w++) {
+      uint32_t word = x[w] + state[w];
+      for (size_t b = 0; b < 4; b++) stream[4 * w + b] = uint8_t(word >> 8 * b);
+    }
+    for (size_t i = 0; i < size; i++) data[i] ^= stream[i];
+    state[12]++;
+  }
+
+#ifdef __SSE2__
+  template <int N>
+  static __m128i rotl(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi32(v, N), _mm_srli_epi32(v, 32 - N));
+  }
+  static void quarter(__m128i& a, __m128i& b, __m128i& c, __m128i& d) {
+    a = _mm_add_epi32(a, b), d = rotl<16>(_mm_xor_si128(d, a));
+    c = _mm_add_epi32(c, d), b = rotl<12>(_mm_xor_si128(b, c));
+    a = _mm_add_epi32(a, b), d = rotl<8>(_mm_xor_si128(d, a));
+    c = _mm_add_epi32(c, d), b = rotl<7>(_mm_xor_si128(b, c));
+  }
+  static void xorInto(uint8_t* data, __m128i stream) {
+    __m128i* p = reinterpret_cast<__m128i*>(data);
+    _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), stream));
+  }
+
+  /* Whole passes of four blocks; returns the bytes done. */
+  static size_t sse2(uint32_t* state, unsigned rounds, uint8_t* data,
+                     size_t size) {
+    const size_t pass = 4 * 64;
+    __m128i in[16], x[16];
+    for (size_t w = 0; w < 16; w++) in[w] = _mm_set1_epi32(int(state[w]));
+    size_t done = 0;
+    for (; size - done >= pass; done += pass, state[12] += 4) {
+      in[12] = _mm_add_epi32(_mm_set1_epi32(int(state[12])),
+                             _mm_setr_epi32(0, 1, 2, 3));
+      memcpy(x, in, sizeof(x));
+      for (unsigned r = 0; r < rounds; r += 2) doubleRound(x);
+      for (size_t w = 0; w < 16; w++) x[w] = _mm_add_epi32(x[w], in[w]);
+
+      for (size_t w = 0; w < 16; w += 4) {  // Transpose words to blocks.
+        __m128i lo01 = _mm_unpacklo_epi32(x[w], x[w + 1]);
+        __m128i lo23 = _mm_unpacklo_epi32(x[w + 2], x[w + 3]);
+        __m128i hi01 = _mm_unpackhi_epi32(x[w], x[w + 1]);
+        __m128i hi23 = _mm_unpackhi_epi32(x[w + 2], x[w + 3]);
+        uint8_t* at = data + done + 4 * w;
+        xorInto(at, _mm_unpacklo_epi64(lo01, lo23));
+        xorInto(at + 64, _mm_unpackhi_epi64(lo01, lo23));
+        xorInto(at + 128, _mm_unpacklo_epi64(hi01, hi23));
+        xorInto(at + 192, _mm_unpackhi_epi64(hi01, hi23));
+      }
+    }
+    return done;
+  }
+#endif
+
+#ifdef CHACHA_AVX2
+  template <int N>
+  CHACHA_AVX2 static __m256i rotl(__m256i v) {
+    return _mm256_or_si256(_mm256_slli_epi32(v, N),
+                           _mm256_srli_epi32(v, 32 - N));
+  }
+  CHACHA_AVX2 static void quarter(__m256i& a, __m256i& b, __m256i& c,
+                                  __m256i& d) {
+    const __m256i rot16 = _mm256_setr_epi8(  // Byte moves, per 32 bits.
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    a = _mm256_add_epi32(a, b);
+    d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot16);
+    c = _mm256_add_epi32(c, d), b = rotl<12>(_mm256_xor_si256(b, c));
+    a = _mm256_add_epi32(a, b);
+    d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot8);
+    c = _mm256_add_epi32(c, d), b = rotl<7>(_mm256_xor_si256(b, c));
+  }
+  CHACHA_AVX2 static void xorInto(uint8_t* data, __m256i stream) {
+    __m128i* p = reinterpret_cast<__m128i*>(data);  // Low half.
+    _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p),
+                                      _mm256_castsi256_si128(stream)));
+    p = reinterpret_cast<__m128i*>(data + 4 * 64);  // High half.
+    _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p),
+                                      _mm256_extracti128_si256(stream, 1)));
+  }
+
+  /* Whole passes of eight blocks; returns the bytes done. The transpose
+   * works within 128 bit halves, so blocks n and n + 4 come out together.
+   */
+  CHACHA_AVX2 static size_t avx2(uint32_t* state, unsigned rounds,
+                                 uint8_t* data, size_t size) {
+    const size_t pass = 8 * 64;
+    __m256i in[16], x[16];
+    for (size_t w = 0; w < 16; w++) in[w] = _mm256_set1_epi32(int(state[w]));
+    size_t done = 0;
+    for (; size - done >= pass; done += pass, state[12] += 8) {
+      in[12] = _mm256_add_epi32(_mm256_set1_epi32(int(state[12])),
+                                _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+      memcpy(x, in, sizeof(x));
+      for (unsigned r = 0; r < rounds; r += 2) {  // doubleRound(), as AVX2.
+        quarter(x[0], x[4], x[8], x[12]), quarter(x[1], x[5], x[9], x[13]);
+        quarter(x[2], x[6], x[10], x[14]), quarter(x[3], x[7], x[11], x[15]);
+        quarter(x[0], x[5], x[10], x[15]), quarter(x[1], x[6], x[11], x[12]);
+        quarter(x[2], x[7], x[8], x[13]), quarter(x[3], x[4], x[9], x[14]);
+      }
+      for (size_t w = 0; w < 16; w++) x[w] = _mm256_add_epi32(x[w], in[w]);
+
+      for (size_t w = 0; w < 16; w += 4) {
+        __m256i lo01 = _mm256_unpacklo_epi32(x[w], x[w + 1]);
+        __m256i lo23 = _mm256_unpacklo_epi32(x[w + 2], x[w + 3]);
+        __m256i hi01 = _mm256_unpackhi_epi32(x[w], x[w + 1]);
+        __m256i hi23 = _mm256_unpackhi_epi32(x[w + 2], x[w + 3]);
+        uint8_t* at = data + done + 4 * w;
+        xorInto(at, _mm256_unpacklo_epi64(lo01, lo23));
+        xorInto(at + 64, _mm256_unpackhi_epi64(lo01, lo23));
+        xorInto(at + 128, _mm256_unpacklo_epi64(hi01, hi23));
+        xorInto(at + 192, _mm256_unpackhi_epi64(hi01, hi23));
+      }
+    }
+    return done;
+  }
+#endif
+
+  static Kernel pick() {
+#ifdef CHACHA_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Avx2;
+#endif
+#ifdef __SSE2__
+    return Sse2;
+#else
+    return Scalar;
+#endif
+  }
+
+ public:
+  ChaCha(const uint32_t key[8], unsigned rounds) : rounds(rounds) {
+    memcpy(this->key, key, sizeof(this->key));
+  }
+  ChaCha(const char* seed, unsigned rounds) : rounds(rounds) {
+    uint32_t h = 2166136261u;  // FNV-1a, stretched over the key words.
+    for (size_t w = 0; w < 8; w++) {
+      for (const char* c = seed; *c; c++) h = (h ^ uint8_t(*c)) * 16777619u;
+      key[w] = h = (h ^ uint32_t(w)) * 16777619u;
+    }
+  }
+
+ public:
+  static Kernel best() {  // The fastest this CPU runs, picked once.
+    static const Kernel kernel = pick();
+    return kernel;
+  }
+  static bool supports(Kernel kernel) {
+    return kernel <= best();
+  }
+  static const char* name(Kernel kernel) {
+    static const char* const names[Kernels] = {"scalar", "SSE2", "AVX2"};
+    return names[kernel];
+  }
+
+  /* XOR size bytes with the keystream starting at block counter, using
+   * kernel, which must be supported.
+   */
+  void apply(uint8_t* data, size_t size, const uint32_t nonce[3],
+             uint32_t counter, Kernel kernel = best()) const {
+    uint32_t state[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+    memcpy(state + 4, key, sizeof(key));
+    state[12] = counter;
+    memcpy(state + 13, nonce, 3 * sizeof(uint32_t));
+
+    size_t done = 0;
+#ifdef CHACHA_AVX2
+    if (kernel == Avx2) done = avx2(state, rounds, data, size);
+#endif
+#ifdef __SSE2__
+    if (kernel >= Sse2) done += sse2(state, rounds, data + done, size - done);
+#endif
+    for (; done < size; done += 64) {
+      block(state, rounds, data + done, min(size - done, size_t(64)));
+    }
+  }
+  void apply(Frame& frame) const {  // Nonce from the frame number.
+    const uint32_t nonce[3] = {0, uint32_t(frame.number),
+                               uint32_t(uint64_t(frame.number) >> 32)};
+    apply(frame.pixels, frame.payload, nonce, 0);
+  }
+};
+
 class Crypto {
  public:
   virtual ~Crypto() {
@@ -138,94 +601,518 @@ class Crypto {
   }
 
  public:
-  virtual string protocol() {
+  virtual const char* protocol() {  // Interned; never freed.
     return "crypto-protocol()";
   }
+  virtual void transform(Frame& frame) {  // XOR with a per-frame keystream.
+    uint64_t state = 0x9E3779B97F4A7C15ULL ^ frame.number;
+    for (const char* c = protocol(); *c; c++) state = state * 31 + *c;
+
+    uint8_t* p = frame.pixels;
+    size_t i = 0;
+    for (; i + 8 <= frame.payload; i += 8) {  // xorshift64 keystream.
+      state ^= state << 13, state ^= state >> 7, state ^= state << 17;
+      uint64_t word;
+      memcpy(&word, p + i, 8);
+      word ^= state;
+      memcpy(p + i, &word, 8);
+    }
+    for (; i < frame.payload; i++) p[i] ^= uint8_t(state >> (8 * (i & 7)));
+  }
 
  public:
   static Crypto* makeObject(const string& criteria);
 };
 class PVP : public Crypto {
+  ChaCha cipher;
+
  public:
+  PVP() : cipher("PVP", 20) {
+  }
   virtual ~PVP() {
     DTOR(" ~PVP", Homework);
   }
 
  public:
-  virtual string protocol() {
+  virtual const char* protocol() {
     return "PVP()";
   }
+  virtual void transform(Frame& frame) {
+    cipher.apply(frame);
+  }
 };
 class ID1 : public Crypto {
+  ChaCha cipher;
+
  public:
+  ID1() : cipher("ID1", 12) {
+  }
   virtual ~ID1() {
     DTOR(" ~ID1", Homework);
   }
 
  public:
-  virtual string protocol() {
+  virtual const char* protocol() {
     return "ID1()";
   }
+  virtual void transform(Frame& frame) {
+    cipher.apply(frame);
+  }
 };
 class RSA : public Crypto {
+  ChaCha cipher;
+
  public:
+  RSA() : cipher("RSA", 8) {
+  }
   virtual ~RSA() {
     DTOR(" ~RSA", Homework);
   }
 
  public:
-  virtual string protocol() {
+  virtual const char* protocol() {
     return "RSA()";
   }
+  virtual void transform(Frame& frame) {
+    cipher.apply(frame);
+  }
 };
 class RDX : public Crypto {
+  ChaCha cipher;
+
  public:
+  RDX() : cipher("RDX", 20) {
+  }
   virtual ~RDX() {
     DTOR(" ~RDX", Homework);
   }
 
  public:
-  virtual string protocol() {
+  virtual const char* protocol() {
     return "RDX()";
   }
+  virtual void transform(Frame& frame) {
+    cipher.apply(frame);
+  }
 };
 // Seam point - add another factory.
 
+const Catalog<Crypto> cryptoCatalog[] = {  // Sorted by name.
+    {"ID1", make<ID1, Crypto>, 0},
+    {"PVP", make<PVP, Crypto>, 0},
+    {"RDX", make<RDX, Crypto>, 0},
+    {"RSA", make<RSA, Crypto>, 0},
+    // Seam point - register another criteria, in order.
+};
+
 Crypto* Crypto::makeObject(const string& criteria) {
-  if (criteria == "PVP")
-    return new PVP;
-  else if (criteria == "ID1")
-    return new ID1;
-  else if (criteria == "RSA")
-    return new RSA;
-  else if (criteria == "RDX")
-    return new RDX;
-  // Seam point - insert another criteria.
-  return new Crypto;
+  const Catalog<Crypto>* entry =
+      find(cryptoCatalog, COUNT(cryptoCatalog), criteria);
+  return entry ? entry->make() : make<Crypto, Crypto>();
 }
 
 void clientCode(int fr, int* res, Display* display, Crypto* crypto) {
-  cout << "  Display " << display->format();
-  cout << " at " << fr << " frames/sec";
-  cout << " with [" << res[0] << ", " << res[1] << "]";
-  cout << " via " << crypto->protocol() << ".\n";
+  out() << "  Display " << display->format();
+  out() << " at " << fr << " frames/sec";
+  out() << " with [" << res[0] << ", " << res[1] << "]";
+  out() << " via " << crypto->protocol() << ".\n";
 }
 
+/* Stream admission. Displays and cryptos are identified by their index in
+ * the catalogs, resolutions and framerates by their index in the tables
+ * below. Which resolution and framerate pairs each display's link, and
+ * each crypto, can carry is worked out once, at startup, into a bitset,
+ * (displays + cryptos) x resolutions x framerates bits in all; an
+ * admission check is then two bit tests, and the bandwidth a stream needs
+ * is one lookup.
+ */
+const int resolutions[][2] = {{640, 480}, {1920, 1080}, {3840, 2160}};
+const int framerates[] = {48, 50, 60, 75, 120};
+const int bitsPerPixel = 24;  // Uncompressed RGB on the link.
+
+template <class Product>  // Catalog index, or count if not found.
+size_t idOf(const Catalog<Product>* catalog, size_t count,
+            const string& name) {
+  const Catalog<Product>* entry = find(catalog, count, name);
+  return entry ? size_t(entry - catalog) : count;
+}
+
+class CapabilityMatrix {
+  static const size_t Modes = COUNT(resolutions) * COUNT(framerates);
+
+  size_t displays;
+  size_t cryptos;
+  vector<uint64_t> bits;  // Row per display, then row per crypto.
+  double gbps[COUNT(resolutions)][COUNT(framerates)];
+
+  template <class Product>
+  void fill(size_t firstRow, const Catalog<Product>* catalog, size_t count) {
+    for (size_t p = 0; p < count; p++) {
+      double limit = catalog[p].gbps;
+      for (size_t r = 0; r < COUNT(resolutions); r++) {
+        for (size_t f = 0; f < COUNT(framerates); f++) {
+          if (limit > 0 && gbps[r][f] > limit) continue;
+          set(firstRow + p, r, f);
+        }
+      }
+    }
+  }
+  void set(size_t row, size_t r, size_t f) {
+    size_t i = row * Modes + r * COUNT(framerates) + f;
+    bits[i / 64] |= uint64_t(1) << (i % 64);
+  }
+  bool test(size_t row, size_t r, size_t f) const {
+    size_t i = row * Modes + r * COUNT(framerates) + f;
+    return (bits[i / 64] >> (i % 64)) & 1;
+  }
+
+ public:
+  CapabilityMatrix(const Catalog<Display>* displayCatalog, size_t displays,
+                   const Catalog<Crypto>* cryptoCatalog, size_t cryptos)
+      : displays(displays), cryptos(cryptos),
+        bits(((displays + cryptos) * Modes + 63) / 64) {
+    for (size_t r = 0; r < COUNT(resolutions); r++) {
+      for (size_t f = 0; f < COUNT(framerates); f++) {
+        gbps[r][f] = double(resolutions[r][0]) * resolutions[r][1] *
+                     bitsPerPixel * framerates[f] * 1e-9;
+      }
+    }
+    fill(0, displayCatalog, displays);
+    fill(displays, cryptoCatalog, cryptos);
+  }
+
+ public:
+  bool supported(size_t d, size_t c, size_t r, size_t f) const {
+    if (d >= displays || c >= cryptos || r >= COUNT(resolutions) ||
+        f >= COUNT(framerates))
+      return false;
+    return test(d, r, f) && test(displays + c, r, f);
+  }
+  double bandwidthGbps(size_t r, size_t f) const {  // 0 if out of range.
+    if (r >= COUNT(resolutions) || f >= COUNT(framerates)) return 0;
+    return gbps[r][f];
+  }
+  size_t bytes() const {
+    return bits.size() * sizeof(uint64_t);
+  }
+};
+
+const CapabilityMatrix& capabilities() {  // For the catalogs as built.
+  static const CapabilityMatrix matrix(displayCatalog, COUNT(displayCatalog),
+                                       cryptoCatalog, COUNT(cryptoCatalog));
+  return matrix;
+}
+
+/* Sustained throughput of frames generated, packed and encrypted. */
+struct Throughput {
+  double framesPerSec;
+  double gbPerSec;
+};
+
+Throughput runPipeline(Display* display, Crypto* crypto, int* res,
+                       int frames) {
+  FramePool pool(res[0], res[1], 2);
+  int done = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (int n = 0; n < frames; n++) {
+    FrameRef frame = pool.acquire();  // Recycled, handed on, not copied.
+    if (!frame) continue;             // Pool ran dry; the frame is lost.
+    frame->generate(n);
+    display->pack(*frame);
+    crypto->transform(*frame);
+    done++;
+  }
+  chrono::duration<double> took = chrono::steady_clock::now() - start;
+
+  Throughput result = {0, 0};
+  if (took.count() > 0) {
+    result.framesPerSec = done / took.count();
+    result.gbPerSec = result.framesPerSec * res[0] * res[1] * 4 * 1e-9;
+  }
+  return result;
+}
+
+void pipelineReport(ostream& to, int fr, int* res, int frames) {
+  for (size_t i = 0; i < COUNT(displayCatalog); i++) {
+    for (size_t j = 0; j < COUNT(cryptoCatalog); j++) {
+      Display* display = displayCatalog[i].make();
+      Crypto* crypto = cryptoCatalog[j].make();
+      Throughput t = runPipeline(display, crypto, res, frames);
+      to << "  " << display->format() << " via " << crypto->protocol()
+         << " with [" << res[0] << ", " << res[1] << "]: " << t.framesPerSec
+         << " frames/sec, " << t.gbPerSec << " GB/sec, "
+         << (t.framesPerSec >= fr ? "keeps up with " : "falls behind ") << fr
+         << " frames/sec.\n";
+    }
+  }
+}
+
+/* Where a Pacer reads the time and sleeps: the monotonic clock, unless a
+ * test substitutes one it advances by hand.
+ */
+class PacerClock {
+ public:
+  typedef chrono::steady_clock::time_point Time;
+
+ public:
+  virtual ~PacerClock() {
+  }
+
+ public:
+  virtual Time now() {
+    return chrono::steady_clock::now();
+  }
+  virtual void sleepUntil(Time when) {
+    this_thread::sleep_until(when);
+  }
+
+ public:
+  static PacerClock* steady() {
+    static PacerClock clock;
+    return &clock;
+  }
+};
+
+/* Paces one stream against its framerate on a PacerClock. Frame n
+ * is released at start + n periods and is due one period later. wait()
+ * sleeps until the release time and records the wake-up jitter; deliver()
+ * checks the due time once the frame is done and records how late a
+ * missed frame was. Every processed frame is delivered, late or not. Under
+ * Drop, a stream that is already past a frame's deadline when it comes to
+ * wait() sheds that frame, and any others whose deadlines have passed,
+ * before doing the work; wait() returns how many it shed, and only those,
+ * plus frames skip()ped, count as dropped.
+ */
+class Pacer {
+ public:
+  enum LatePolicy { Deliver, Drop };
+  static const size_t Buckets = 24;  // log2 of microseconds.
+
+ private:
+  PacerClock* clock;
+  chrono::steady_clock::duration period;
+  PacerClock::Time release;
+  LatePolicy policy;
+  bool started;
+
+ public:
+  unsigned long delivered;
+  unsigned long dropped;
+  unsigned long missed;
+  unsigned long jitter[Buckets];
+  unsigned long lateness[Buckets];
+
+ public:
+  explicit Pacer(int framerate, LatePolicy policy = Drop,
+                 PacerClock* clock = PacerClock::steady())
+      : clock(clock),
+        period(chrono::duration_cast<chrono::steady_clock::duration>(
+            chrono::duration<double>(1.0 / (framerate > 0 ? framerate : 1)))),
+        policy(policy), started(false), delivered(0), dropped(0), missed(0) {
+    memset(jitter, 0, sizeof(jitter));
+    memset(lateness, 0, sizeof(lateness));
+  }
+
+ public:
+  /* Frames shed, at most most, ahead of the one to process next. */
+  unsigned long wait(unsigned long most = ~0UL) {
+    if (!started) {
+      release = clock->now();
+      started = true;
+    }
+    unsigned long shed = 0;
+    if (policy == Drop) {
+      PacerClock::Time now = clock->now();
+      for (; shed < most && release + period <= now; shed++) {
+        release += period;
+      }
+      dropped += shed;
+      if (shed && shed == most) return shed;  // Nothing left to wait for.
+    }
+    clock->sleepUntil(release);
+    record(jitter, clock->now() - release);
+    return shed;
+  }
+  bool deliver() {  // False if the frame missed its deadline.
+    PacerClock::Time now = clock->now();
+    PacerClock::Time due = release + period;
+    release = due;
+    delivered++;
+    if (now <= due) return true;
+    missed++;
+    record(lateness, now - due);
+    return false;
+  }
+  void skip() {  // The frame was lost before it could be processed.
+    release += period;
+    dropped++;
+  }
+
+  void report(ostream& to) const {
+    to << "    " << delivered << " delivered, " << dropped << " dropped, "
+       << missed << " missed deadlines.\n";
+    histogram(to, "    wake-up jitter", jitter);
+    histogram(to, "    missed by", lateness);
+  }
+
+ private:
+  static void record(unsigned long* histogram,
+                     chrono::steady_clock::duration d) {
+    long long us = chrono::duration_cast<chrono::microseconds>(d).count();
+    size_t b = 0;
+    while (b < Buckets - 1 && (1LL << b) < us) b++;
+    histogram[b]++;
+  }
+  static void histogram(ostream& to, const char* name,
+                        const unsigned long* counts) {
+    to << name << ":";
+    for (size_t b = 0; b < Buckets; b++) {
+      if (counts[b]) to << " <=" << (1LL << b) << "us: " << counts[b];
+    }
+    to << "\n";
+  }
+};
+
+/* Runs many independent streams at once on a work-stealing pool, one task
+ * per stream, and reports each stream's throughput and frame latency.
+ * When paced, each stream runs at its framerate under a Pacer and sleeps
+ * between frames, so each needs a thread of its own: if the given pool is
+ * smaller than that, the run gets a pool with one worker per stream.
+ * Latency is timed on the same PacerClock the pacers use. Capacity is
+ * what the stream's work alone could sustain; a paced stream delivers no
+ * more than its framerate, and fewer when it falls behind.
+ */
+struct StreamStats {
+  double deliveredPerSec;  // Frames processed per second of the run.
+  double capacityPerSec;   // Frames per second of work, idle time excluded.
+  double gbPerSec;         // At capacity.
+  double p50Ms;
+  double p99Ms;
+  double maxMs;
+};
+
+class StreamEngine {
+  vector<StreamConfig> streams;
+  vector<StreamStats> stats;
+  vector<Pacer> pacers;
+  PacerClock* clock;
+  int frames;
+  bool paced;
+
+  struct Task {
+    StreamEngine* engine;
+    void operator()(size_t i) {
+      engine->stats[i] = engine->runStream(engine->streams[i],
+                                           engine->pacers[i]);
+    }
+  };
+
+ public:
+  StreamEngine() : clock(PacerClock::steady()), frames(0), paced(false) {
+  }
+
+ public:
+  void add(const StreamConfig& stream) {
+    streams.push_back(stream);
+  }
+  const vector<StreamStats>& run(int frames, WorkStealingPool& pool,
+                                 bool paced = false,
+                                 Pacer::LatePolicy policy = Pacer::Drop,
+                                 PacerClock* clock = PacerClock::steady()) {
+    this->frames = frames;
+    this->paced = paced;
+    this->clock = clock;
+    stats.assign(streams.size(), StreamStats());
+    pacers.clear();
+    for (size_t i = 0; i < streams.size(); i++) {
+      pacers.push_back(Pacer(streams[i].framerate, policy, clock));
+    }
+    Task task = {this};
+    if (paced && pool.size() < streams.size()) {
+      WorkStealingPool perStream(unsigned(streams.size()));
+      perStream.run(streams.size(), task);
+    } else {
+      pool.run(streams.size(), task);
+    }
+    return stats;
+  }
+  const Pacer& pacer(size_t stream) const {  // Of the last paced run.
+    return pacers[stream];
+  }
+  void report(ostream& to) const {
+    for (size_t i = 0; i < stats.size(); i++) {
+      const StreamConfig& s = streams[i];
+      to << "  Stream " << i << ": " << s.display->format() << " via "
+         << s.crypto->protocol() << " with [" << s.res[0] << ", " << s.res[1]
+         << "] at " << s.framerate << " frames/sec: delivered "
+         << stats[i].deliveredPerSec << " frames/sec, capacity "
+         << stats[i].capacityPerSec << " frames/sec (" << stats[i].gbPerSec
+         << " GB/sec), p50 "
+         << stats[i].p50Ms << " ms, p99 " << stats[i].p99Ms << " ms, max "
+         << stats[i].maxMs << " ms.\n";
+      if (paced) pacers[i].report(to);
+    }
+  }
+
+ private:
+  StreamStats runStream(const StreamConfig& stream, Pacer& pacer) const {
+    StreamStats result = {0, 0, 0, 0, 0, 0};
+    if (frames <= 0) return result;
+
+    FramePool pool(stream.res[0], stream.res[1], 2);
+    vector<double> latencyMs;  // Of the frames processed.
+    latencyMs.reserve(frames);
+    chrono::duration<double> total(0);
+    PacerClock::Time begun = clock->now();
+    for (int n = 0; n < frames; n++) {
+      if (paced) {
+        n += int(pacer.wait(frames - n));  // Past frames shed by policy.
+        if (n == frames) break;
+      }
+      PacerClock::Time start = clock->now();
+      FrameRef frame = pool.acquire();
+      if (!frame) {  // Pool ran dry; the frame is lost.
+        if (paced) pacer.skip();
+        continue;
+      }
+      frame->generate(n);
+      stream.display->pack(*frame);
+      stream.crypto->transform(*frame);
+      chrono::duration<double> took = clock->now() - start;
+      latencyMs.push_back(took.count() * 1e3);
+      total += took;
+      if (paced) pacer.deliver();
+    }
+    if (latencyMs.empty()) return result;
+
+    chrono::duration<double> elapsed = clock->now() - begun;
+    if (elapsed.count() > 0) {
+      result.deliveredPerSec = latencyMs.size() / elapsed.count();
+    }
+    if (total.count() > 0) {
+      result.capacityPerSec = latencyMs.size() / total.count();
+      result.gbPerSec =
+          result.capacityPerSec * stream.res[0] * stream.res[1] * 4 * 1e-9;
+    }
+    sort(latencyMs.begin(), latencyMs.end());
+    result.p50Ms = latencyMs[latencyMs.size() / 2];
+    result.p99Ms = latencyMs[(latencyMs.size() - 1) * 99 / 100];
+    result.maxMs = latencyMs.back();
+    return result;
+  }
+};
+
 void demo(int seqNo) {
-  cout << seqNo << ") << factory_method::homework::solution::demo() >>\n";
-  framerate = 60;
-  res[0] = 1920, res[1] = 1080;
+  out() << seqNo << ") << factory_method::homework::solution::demo() >>\n";
+  StreamConfig stream = {0, 0, 60, {1920, 1080}};
   string displays[] = {"DisplayPort", "HDMI", "MIPI", "Widi", "HEVC"};
   string cryptos[] = {"PVP", "ID1", "RSA", "RDX"};
   for (size_t i = 0; i < COUNT(displays); i++) {
-    Display* display = Display::makeObject(displays[i]);
-    vector<Crypto*> crypto;
+    stream.display = Display::makeObject(displays[i]);  // Shared, interned.
     for (size_t j = 0; j < COUNT(cryptos); j++) {
-      crypto.push_back(Crypto::makeObject(cryptos[j]));
-      clientCode(framerate, res, display, crypto[j]);
+      stream.crypto = Crypto::makeObject(cryptos[j]);
+      clientCode(stream.framerate, stream.res, stream.display, stream.crypto);
     }
-    for (size_t j = 0; j < COUNT(cryptos); j++) delete crypto[j];
-    delete display;
   }
 }
 
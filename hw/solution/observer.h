@@ -86,7 +86,7 @@ class Thing : public Listener {
 
  public:
   void update(Perpetrator*) {
-    cout << "    Thing " << name << " makes mischief.\n";
+    out() << "    Thing " << name << " makes mischief.\n";
   }
 };
 class Child : public Listener {
@@ -99,7 +99,7 @@ class Child : public Listener {
 
  public:
   void update(Perpetrator*) {
-    cout << "    " << name << " laughs.\n";
+    out() << "    " << name << " laughs.\n";
   }
 };
 class Fish : public Listener {
@@ -113,7 +113,7 @@ class Fish : public Listener {
 
  public:
   void update(Perpetrator*) {
-    cout << "    " << name << " complains.\n";
+    out() << "    " << name << " complains.\n";
   }
 };
 class Mom : public Listener {
@@ -127,13 +127,13 @@ class Mom : public Listener {
 
  public:
   void update(Perpetrator*) {
-    cout << "    " << name << " asks \"how was your day?\"\n";
+    out() << "    " << name << " asks \"how was your day?\"\n";
   }
 };
 // Seam point - add another Listener.
 
 void Perpetrator::says(const string& phrase) {
-  cout << "  " << name << " says " << phrase << ".\n";
+  out() << "  " << name << " says " << phrase << ".\n";
   list<Listener*>::iterator it = listeners.begin();
   for (; it != listeners.end(); ++it) {
     (*it)->update(this);
@@ -141,7 +141,7 @@ void Perpetrator::says(const string& phrase) {
 }
 
 void demo(int seqNo) {
-  cout << seqNo << ") << observer::homework::solution::demo() >>\n";
+  out() << seqNo << ") << observer::homework::solution::demo() >>\n";
   {
     Perpetrator perp("Cat in the Hat");
 
@@ -180,7 +180,7 @@ void demo(int seqNo) {
     delete fish;
     delete mom;
   }
-  cout << endl;
+  out() << endl;
 }
 
 }  // solution
@@ -20,6 +20,23 @@ enum Way {
   // Seam point #1 - add another way.
 };
 
+/* Set by whoever no longer needs a way's result. */
+class CancelToken {
+  atomic<bool> flag;
+
+ public:
+  CancelToken() : flag(false) {
+  }
+
+ public:
+  bool cancelled() const {
+    return flag.load(memory_order_relaxed);
+  }
+  void cancel() {
+    flag.store(true, memory_order_relaxed);
+  }
+};
+
 class WayBase {
  public:
   virtual ~WayBase() {
@@ -28,10 +45,15 @@ class WayBase {
 
  public:
   virtual void way() {
-    cout << "  WayBase.way()";
+    out() << "  WayBase.way()";
+  }
+  virtual bool cancellableWay(const CancelToken& token) {  // False if beaten.
+    if (token.cancelled()) return false;
+    way();
+    return true;
   }
 };
-class HardWay : public WayBase {
+class HardWay final : public WayBase {
  public:
   ~HardWay() {
     DTOR("~HardWay()\n", Homework);
@@ -39,10 +61,10 @@ class HardWay : public WayBase {
 
  public:
   virtual void way() {
-    cout << "The hard way.\n";
+    out() << "The hard way.\n";
   }
 };
-class EasyWay : public WayBase {
+class EasyWay final : public WayBase {
  public:
   ~EasyWay() {
     DTOR("~EasyWay()\n", Homework);
@@ -50,10 +72,10 @@ class EasyWay : public WayBase {
 
  public:
   virtual void way() {
-    cout << "The easy way.\n";
+    out() << "The easy way.\n";
   }
 };
-class QuickWay : public WayBase {
+class QuickWay final : public WayBase {
  public:
   ~QuickWay() {
     DTOR("~QuickWay()\n", Homework);
@@ -61,10 +83,10 @@ class QuickWay : public WayBase {
 
  public:
   virtual void way() {
-    cout << "The quick way.\n";
+    out() << "The quick way.\n";
   }
 };
-class ClearWay : public WayBase {
+class ClearWay final : public WayBase {
  public:
   ~ClearWay() {
     DTOR("~ClearWay()\n", Homework);
@@ -72,57 +94,692 @@ class ClearWay : public WayBase {
 
  public:
   virtual void way() {
-    cout << "The clear way.\n";
+    out() << "The clear way.\n";
   }
 };
 // Seam point #2 - add another way.
 
-void clientCode1(WayBase* my) {
-  cout << "  clientCode1 - ";
+/* The ways are stateless, so one instance of each is built up front and
+ * handed out by index (a Flyweight). Dispatch is a single table load,
+ * nothing is allocated per call, and the registry owns the instances.
+ */
+const size_t WayCount = 4;  // Ways in lookup()'s registry.
+
+WayBase* lookup(Way criteria) {
+  static HardWay hard;
+  static EasyWay easy;
+  static QuickWay quick;
+  static ClearWay clear;
+  // Seam point #3 - add another way.
+  static WayBase* const registry[] = {&hard, &easy, &quick, &clear};
+  static_assert(COUNT(registry) == WayCount, "WayCount out of step");
+  static WayBase oops;
+
+  if (size_t(criteria) < COUNT(registry)) return registry[criteria];
+  return &oops;  // OOPs!
+}
+
+/* Closed-set alternative to WayBase for when every way is known up front.
+ * The switch calls through the final classes, so each arm binds statically.
+ */
+class WayVariant {
+  Way tag;
+
+ public:
+  explicit WayVariant(Way tag) : tag(tag) {
+  }
+
+ public:
+  void way() {
+    switch (tag) {
+      case Hard:
+        static_cast<HardWay*>(lookup(Hard))->way();
+        break;
+      case Easy:
+        static_cast<EasyWay*>(lookup(Easy))->way();
+        break;
+      case Quick:
+        static_cast<QuickWay*>(lookup(Quick))->way();
+        break;
+      case Clear:
+        static_cast<ClearWay*>(lookup(Clear))->way();
+        break;
+      // Seam point #4 - add another way.
+      default:
+        lookup(tag)->way();
+    }
+  }
+};
+
+/* Client code is written once against any type with a way() member.
+ * Through WayBase* the call is virtual; through a final way or a
+ * WayVariant the compiler knows the target and can inline it.
+ */
+template <class W>  // WayBase, a final way, or WayVariant.
+void clientCode1(W* my) {
+  out() << "  clientCode1 - ";
   my->way();
 }
-void clientCode2(WayBase* my) {
-  cout << "  clientCode2 - ";
+template <class W>
+void clientCode2(W* my) {
+  out() << "  clientCode2 - ";
   my->way();
 }
-void clientCode3(WayBase* my) {
-  cout << "  clientCode3 - ";
+template <class W>
+void clientCode3(W* my) {
+  out() << "  clientCode3 - ";
   my->way();
 }
 //...
-void clientCode18(WayBase* my) {
-  cout << "  clientCode18 - ";
+template <class W>
+void clientCode18(W* my) {
+  out() << "  clientCode18 - ";
   my->way();
 }
 
-void demo(int seqNo) {  // Test all the daughter classes & clients.
-  cout << seqNo << ") << strategy::homework::solution::demo(seqNo) >>\n";
-  Way criteria[] = {Hard, Easy, Quick, Clear};
-  for (size_t i = 0; i < COUNT(criteria); i++) {
-    WayBase* ptr = 0;
-
-    if (criteria[i] == Hard)
-      ptr = new HardWay;  // Hint: will become Factory pattern.
-    else if (criteria[i] == Easy)
-      ptr = new EasyWay;
-    else if (criteria[i] == Quick)
-      ptr = new QuickWay;
-    else if (criteria[i] == Clear)
-      ptr = new ClearWay;
-    // Seam point #3 - add another way.
-    else
-      ptr = new WayBase;  // OOPs!
-
-    clientCode1(ptr);
-    clientCode2(ptr);
-    clientCode3(ptr);
+/* Batch dispatch over a large, mixed run of criteria. Items are bucketed
+ * by way with a counting sort (each bucket keeps its original order) and
+ * each bucket runs back to back, keeping the indirect call predictable.
+ * The client is called as client(item, way) in grouped order. A WayBatch
+ * keeps its index buffer, so reusing one allocates nothing once warm.
+ */
+class WayBatch {
+  vector<size_t> order;
+
+  static size_t bucket(Way criteria) {  // Unknown ways share the last.
+    return size_t(criteria) < WayCount ? size_t(criteria) : WayCount;
+  }
+
+ public:
+  template <class Client>
+  void run(const Way* criteria, size_t count, Client client) {
+    size_t next[WayCount + 1] = {0};
+    for (size_t i = 0; i < count; i++) next[bucket(criteria[i])]++;
+    size_t start = 0;
+    for (size_t b = 0; b <= WayCount; b++) {
+      size_t size = next[b];
+      next[b] = start;
+      start += size;
+    }
+
+    order.resize(count);
+    for (size_t i = 0; i < count; i++) order[next[bucket(criteria[i])]++] = i;
+
+    size_t i = 0;
+    for (size_t b = 0; b <= WayCount; b++) {
+      WayBase* my = lookup(Way(b));  // b == WayCount gives the fallback.
+      for (; i < next[b]; i++) client(order[i], my);
+    }
+  }
+};
+
+template <class Client>
+void batch(const Way* criteria, size_t count, Client client) {
+  WayBatch grouped;
+  grouped.run(criteria, count, client);
+}
+
+/* Self-tuning choice among interchangeable ways, one selector per client.
+ * Each call runs the way with the lowest smoothed latency, except every
+ * explorePeriod-th call, which samples the candidates round robin so the
+ * choice can follow the hardware. Latency per way is kept as an EWMA and a
+ * log2 histogram (for the p99).
+ */
+class WaySelector {
+  static const size_t Buckets = 40;  // log2 of nanoseconds.
+
+  struct Stats {
+    Way way;
+    double ewma;  // Nanoseconds, negative until first sample.
+    unsigned long samples;
+    unsigned long histogram[Buckets];
+  };
+
+  vector<Stats> stats;
+  double alpha;
+  size_t explorePeriod;
+  size_t calls;
+  size_t explored;
+
+ public:
+  WaySelector(const Way* ways, size_t count, size_t explorePeriod = 64,
+              double alpha = 0.125)
+      : stats(count), alpha(alpha), explorePeriod(explorePeriod), calls(0),
+        explored(0) {
+    assert(count > 0 && explorePeriod > 0);
+    for (size_t i = 0; i < count; i++) {
+      memset(&stats[i], 0, sizeof(Stats));
+      stats[i].way = ways[i];
+      stats[i].ewma = -1;
+    }
+  }
+
+ public:
+  template <class Client>  // Called as client(WayBase*).
+  void run(Client client) {
+    size_t pick = fastest();
+    if (stats[pick].ewma < 0 || calls++ % explorePeriod == 0) {
+      pick = explored++ % stats.size();
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    client(lookup(stats[pick].way));
+    chrono::steady_clock::duration took = chrono::steady_clock::now() - start;
+    record(stats[pick],
+           double(chrono::duration_cast<chrono::nanoseconds>(took).count()));
+  }
+
+  Way best() const {
+    return stats[fastest()].way;
+  }
+  double ewma(size_t i) const {
+    return stats[i].ewma;
+  }
+  double p99(size_t i) const {  // Upper bound of the p99 bucket, in ns.
+    unsigned long seen = 0;
+    for (size_t b = 0; b < Buckets; b++) {
+      seen += stats[i].histogram[b];
+      if (100 * seen >= 99 * stats[i].samples) return double(1ULL << b);
+    }
+    return double(1ULL << (Buckets - 1));
+  }
+
+ private:
+  size_t fastest() const {  // Unmeasured ways sort first.
+    size_t best = 0;
+    for (size_t i = 1; i < stats.size(); i++) {
+      if (stats[i].ewma < stats[best].ewma) best = i;
+    }
+    return best;
+  }
+  void record(Stats& s, double ns) {
+    s.ewma = (s.ewma < 0) ? ns : s.ewma + alpha * (ns - s.ewma);
+    size_t b = 0;
+    while (b < Buckets - 1 && double(1ULL << b) < ns) b++;
+    s.histogram[b]++;
+    s.samples++;
+  }
+};
+
+/* The active way for a client, swappable while other threads keep calling
+ * through it. Readers pay one acquire load. Handles only ever point at
+ * registry-owned ways, which live until exit, so a swapped-out way never
+ * needs reclaiming and readers never need to announce themselves.
+ */
+class WayHandle {
+  atomic<WayBase*> active;
+
+ public:
+  explicit WayHandle(Way criteria) : active(lookup(criteria)) {
+  }
+
+ public:
+  WayBase* get() const {
+    return active.load(memory_order_acquire);
+  }
+  WayBase* operator->() const {
+    return get();
+  }
+  void swap(Way criteria) {
+    active.store(lookup(criteria), memory_order_release);
+  }
+};
+
+/* Speculative racing: run several ways at once for one request and keep
+ * the first result. Each contender is called as client(way, token) on a
+ * worker of the race's pool and should hand the token on to the way, via
+ * way->cancellableWay(token), or poll token.cancelled() itself, and return
+ * false once it is set; the first to return true claims the result and
+ * cancels the rest. Only the winner's output reaches out(). Across races,
+ * wins per way and the time losers spent are accumulated.
+ */
+class Race {
+  vector<unsigned long> wins;  // Indexed by Way.
+  unsigned long races;
+  double wastedNs;
+  mutable mutex lock;  // Guards the three above.
+  WorkStealingPool pool;
+
+  template <class Client>
+  struct Contender {
+    Race* race;
+    Client* client;
+    CancelToken* token;
+    atomic<int>* winner;
+    const Way* ways;
+    string* output;  // The winner's.
+
+    void operator()(size_t i) {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      ostringstream captured;
+      bool done;
+      {
+        Redirect redirect(captured);
+        done = (*client)(lookup(ways[i]), *token);
+      }
+      int none = -1;
+      if (done && winner->compare_exchange_strong(none, int(ways[i]))) {
+        *output = captured.str();
+        token->cancel();
+        return;
+      }
+      chrono::steady_clock::duration took = chrono::steady_clock::now() - start;
+      race->waste(chrono::duration_cast<chrono::nanoseconds>(took).count());
+    }
+  };
+
+  struct Plain {  // Races the ways themselves.
+    bool operator()(WayBase* my, const CancelToken& token) {
+      return my->cancellableWay(token);
+    }
+  };
+
+  void waste(double ns) {
+    lock_guard<mutex> guard(lock);
+    wastedNs += ns;
+  }
+
+ public:
+  explicit Race(unsigned contenders = 4)  // Threads kept for racing.
+      : races(0), wastedNs(0), pool(contenders) {
+  }
+
+ public:
+  template <class Client>  // bool client(WayBase*, const CancelToken&).
+  int run(const Way* ways, size_t count, Client client) {  // -1 if none won.
+    CancelToken token;
+    atomic<int> winner(-1);
+    string output;
+    Contender<Client> contender = {this, &client, &token, &winner, ways,
+                                   &output};
+    pool.run(count, contender);
+    out() << output;
+
+    int won = winner.load();
+    lock_guard<mutex> guard(lock);
+    races++;
+    if (won >= 0) {
+      if (wins.size() <= size_t(won)) wins.resize(won + 1);
+      wins[won]++;
+    }
+    return won;
+  }
+  int run(const Way* ways, size_t count) {
+    return run(ways, count, Plain());
+  }
+
+  unsigned long winsFor(Way way) const {
+    lock_guard<mutex> guard(lock);
+    return (size_t(way) < wins.size()) ? wins[way] : 0;
+  }
+  unsigned long total() const {
+    lock_guard<mutex> guard(lock);
+    return races;
+  }
+  double wastedSeconds() const {  // Time losers ran before standing down.
+    lock_guard<mutex> guard(lock);
+    return wastedNs * 1e-9;
+  }
+};
+
+/* Way assignment for a large population of client ids. Open addressing
+ * with linear probing over two flat arrays (ids, one byte of way each),
+ * so a lookup touches one or two cache lines and an entry costs 5 bytes
+ * at full load. The all-ones id is reserved to mark empty slots.
+ */
+class ClientWays {
+  static const uint32_t Empty = 0xFFFFFFFFu;
+
+  vector<uint32_t> ids;
+  vector<uint8_t> ways;
+  size_t used;
+  unsigned shift;  // 32 - log2(capacity): the hash keeps the top bits.
+
+ public:
+  explicit ClientWays(size_t expected = 16) : used(0), shift(32) {
+    rehash(expected);
+  }
+
+ public:
+  void assign(uint32_t id, Way way) {
+    assert(id != Empty);
+    size_t slot = probe(id);
+    if (ids[slot] == Empty) {  // Only a new id can need room.
+      if (2 * (used + 1) > ids.size()) {
+        rehash(ids.size());
+        slot = probe(id);
+      }
+      ids[slot] = id;
+      used++;
+    }
+    ways[slot] = uint8_t(way);
+  }
+  void bulkLoad(const uint32_t* id, const Way* way, size_t count) {
+    reserve(used + count);
+    for (size_t i = 0; i < count; i++) assign(id[i], way[i]);
+  }
+  void reassign(const uint32_t* id, size_t count, Way way) {
+    size_t added = 0;  // Room only for ids not already assigned.
+    for (size_t i = 0; i < count; i++) added += ids[probe(id[i])] == Empty;
+    reserve(used + added);
+    for (size_t i = 0; i < count; i++) assign(id[i], way);
+  }
+  bool find(uint32_t id, Way& way) const {
+    size_t slot = probe(id);
+    if (ids[slot] == Empty) return false;
+    way = Way(ways[slot]);
+    return true;
+  }
+  WayBase* lookup(uint32_t id, Way fallback) const {
+    Way way = fallback;
+    find(id, way);
+    return solution::lookup(way);
+  }
+
+  template <class Visitor>  // Called as visit(id, way) for every entry.
+  void forEach(Visitor visit) const {
+    for (size_t i = 0; i < ids.size(); i++) {
+      if (ids[i] != Empty) visit(ids[i], Way(ways[i]));
+    }
+  }
+  size_t size() const {
+    return used;
+  }
+  size_t bytes() const {
+    return ids.size() * (sizeof(uint32_t) + sizeof(uint8_t));
+  }
+  void reserve(size_t count) {
+    if (2 * count > ids.size()) rehash(count);
+  }
+
+ private:
+  size_t probe(uint32_t id) const {  // Slot holding id, or the empty one.
+    size_t mask = ids.size() - 1;
+    size_t slot = uint32_t(id * 0x9E3779B1u) >> shift;  // Fibonacci hashing.
+    while (ids[slot] != id && ids[slot] != Empty) slot = (slot + 1) & mask;
+    return slot;
+  }
+  void rehash(size_t count) {  // Capacity: power of two, at most half full.
+    size_t capacity = 16;
+    shift = 28;
+    while (capacity < 2 * count) capacity *= 2, shift--;
+    vector<uint32_t> oldIds(capacity, uint32_t(Empty));
+    vector<uint8_t> oldWays(capacity, 0);
+    oldIds.swap(ids);
+    oldWays.swap(ways);
+    for (size_t i = 0; i < oldIds.size(); i++) {
+      if (oldIds[i] == Empty) continue;
+      size_t slot = probe(oldIds[i]);
+      ids[slot] = oldIds[i];
+      ways[slot] = oldWays[i];
+    }
+  }
+};
+
+/* Sampling profiler for strategy dispatch. Every profiled call is counted
+ * and one in sampleEvery is timed into an HDR-style latency histogram:
+ * power-of-two ranges split into 8 linear sub-buckets, so every bucket is
+ * within 12.5% of the latencies it holds. Each thread records into its
+ * own table; report() and json() merge them. A thread's table goes back
+ * on a spare list when the thread ends and the next new thread takes it
+ * over, counts and all. While disabled a call costs one relaxed load.
+ */
+class WayProfiler {
+  static const size_t Ways = WayCount + 1;  // Unknown ways share the last.
+  static const size_t SubBits = 3;
+  static const size_t SubBuckets = 1 << SubBits;
+  static const size_t Buckets = SubBuckets * (40 - SubBits + 1);  // < 2^40.
+
+  struct Counters {
+    atomic<unsigned long> calls;
+    atomic<unsigned long> sampled;
+    atomic<unsigned long> histogram[Buckets];
+  };
+  struct Table {  // Written only by the thread that holds it.
+    Counters ways[Ways];
+    unsigned long tick;
+  };
+  struct Holder {  // This thread's table, handed back when the thread ends.
+    WayProfiler* owner;
+    Table* table;
+
+    ~Holder() {
+      if (table) owner->release(table);
+    }
+  };
+
+  atomic<bool> enabled;
+  atomic<unsigned long> sampleEvery;  // Rewritten while threads record.
+  mutex lock;
+  vector<Table*> tables;  // Every table, held or spare.
+  vector<Table*> spare;
+
+  WayProfiler() : enabled(false), sampleEvery(1) {
+  }
+  friend WayProfiler& profiler();
+
+ public:
+  ~WayProfiler() {
+    for (size_t i = 0; i < tables.size(); i++) delete tables[i];
+  }
+
+ public:
+  void enable(unsigned long sampleEvery = 1) {
+    this->sampleEvery.store(sampleEvery ? sampleEvery : 1,
+                            memory_order_relaxed);
+    enabled.store(true);
+  }
+  void disable() {
+    enabled.store(false);
+  }
+  void reset() {  // Zero the counts; only while no thread is recording.
+    lock_guard<mutex> guard(lock);
+    for (size_t t = 0; t < tables.size(); t++) clear(*tables[t]);
+  }
+
+  template <class Call>  // Runs call(), attributing it to way.
+  void call(Way way, Call call) {
+    if (!enabled.load(memory_order_relaxed)) return call();
+
+    Table& table = local();
+    Counters& counters = table.ways[row(way)];
+    bump(counters.calls);
+    if (table.tick++ % sampleEvery.load(memory_order_relaxed)) {
+      return call();
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    call();
+    chrono::steady_clock::duration took = chrono::steady_clock::now() - start;
+    bump(counters.histogram[bucket(
+        chrono::duration_cast<chrono::nanoseconds>(took).count())]);
+    bump(counters.sampled);
+  }
+
+  size_t tableCount() {  // At most the threads ever recording at once.
+    lock_guard<mutex> guard(lock);
+    return tables.size();
+  }
+  unsigned long calls(Way way) {
+    Table merged;
+    merge(merged);
+    return merged.ways[row(way)].calls;
+  }
+  unsigned long long percentile(Way way, double p) {  // Bucket top, in ns.
+    Table merged;
+    merge(merged);
+    return percentile(merged.ways[row(way)], p);
+  }
+
+  void report(ostream& to) {
+    Table merged;
+    merge(merged);
+    to << "Way profile (1 in " << sampleEvery.load() << " calls timed):\n";
+    for (size_t w = 0; w < Ways; w++) {
+      Counters& c = merged.ways[w];
+      if (!c.calls) continue;
+      to << "  way " << w << ": " << c.calls << " calls, " << c.sampled
+         << " sampled, p50 " << percentile(c, 50) << " ns, p99 "
+         << percentile(c, 99) << " ns, p99.9 " << percentile(c, 99.9)
+         << " ns\n";
+      for (size_t b = 0; b < Buckets; b++) {
+        if (c.histogram[b]) {
+          to << "    <= " << top(b) << " ns: " << c.histogram[b] << "\n";
+        }
+      }
+    }
+  }
+
+  void json(ostream& to) {
+    Table merged;
+    merge(merged);
+    to << "{\"sampleEvery\": " << sampleEvery.load() << ", \"ways\": [";
+    const char* sep = "";
+    for (size_t w = 0; w < Ways; w++) {
+      Counters& c = merged.ways[w];
+      if (!c.calls) continue;
+      to << sep << "{\"way\": " << w << ", \"calls\": " << c.calls
+         << ", \"sampled\": " << c.sampled << ", \"p50Ns\": "
+         << percentile(c, 50) << ", \"p99Ns\": " << percentile(c, 99)
+         << ", \"histogramNs\": {";
+      const char* sep2 = "";
+      for (size_t b = 0; b < Buckets; b++) {
+        if (!c.histogram[b]) continue;
+        to << sep2 << "\"" << top(b) << "\": " << c.histogram[b];
+        sep2 = ", ";
+      }
+      to << "}}";
+      sep = ", ";
+    }
+    to << "]}\n";
+  }
+
+ private:
+  static size_t row(Way way) {
+    return size_t(way) < WayCount ? size_t(way) : WayCount;
+  }
+  static size_t bucket(unsigned long long ns) {
+    if (ns < SubBuckets) return size_t(ns);
+    size_t major = 0;
+    while (ns >> (major + 1)) major++;  // floor(log2(ns)), >= SubBits.
+    size_t shift = major - SubBits;
+    size_t b = SubBuckets * (shift + 1) + size_t((ns >> shift) - SubBuckets);
+    return b < Buckets ? b : Buckets - 1;
+  }
+  static unsigned long long top(size_t b) {  // Largest ns in bucket b.
+    if (b < SubBuckets) return b;
+    size_t shift = b / SubBuckets - 1;
+    unsigned long long low = (SubBuckets + b % SubBuckets) * (1ULL << shift);
+    return low + (1ULL << shift) - 1;
+  }
+  static unsigned long long percentile(Counters& c, double p) {
+    unsigned long seen = 0;
+    for (size_t b = 0; b < Buckets; b++) {
+      seen += c.histogram[b];
+      if (seen && 100 * double(seen) >= p * c.sampled) return top(b);
+    }
+    return 0;
+  }
+
+  static void bump(atomic<unsigned long>& n) {  // Single writer, no RMW.
+    n.store(n.load(memory_order_relaxed) + 1, memory_order_relaxed);
+  }
+  static void clear(Table& table) {
+    for (size_t w = 0; w < Ways; w++) {
+      table.ways[w].calls = 0;
+      table.ways[w].sampled = 0;
+      for (size_t b = 0; b < Buckets; b++) table.ways[w].histogram[b] = 0;
+    }
+    table.tick = 0;
+  }
+  Table& local() {
+    static thread_local Holder holder = {this, 0};
+    if (!holder.table) holder.table = acquire();
+    return *holder.table;
+  }
+  Table* acquire() {
+    lock_guard<mutex> guard(lock);
+    if (!spare.empty()) {
+      Table* table = spare.back();
+      spare.pop_back();
+      return table;
+    }
+    Table* table = new Table;
+    clear(*table);
+    tables.push_back(table);
+    return table;
+  }
+  void release(Table* table) {
+    lock_guard<mutex> guard(lock);
+    spare.push_back(table);
+  }
+  void merge(Table& merged) {
+    clear(merged);
+    lock_guard<mutex> guard(lock);
+    for (size_t t = 0; t < tables.size(); t++) {
+      for (size_t w = 0; w < Ways; w++) {
+        Counters& from = tables[t]->ways[w];
+        Counters& to = merged.ways[w];
+        to.calls += from.calls.load(memory_order_relaxed);
+        to.sampled += from.sampled.load(memory_order_relaxed);
+        for (size_t b = 0; b < Buckets; b++) {
+          to.histogram[b] += from.histogram[b].load(memory_order_relaxed);
+        }
+      }
+    }
+  }
+};
+
+WayProfiler& profiler() {  // The one instance; thread tables refer to it.
+  static WayProfiler instance;
+  return instance;
+}
+
+/* The client x way matrix in parallel. The cells are independent, so they
+ * run on a work-stealing pool; their output is replayed in matrix order,
+ * identical to running them one after another.
+ */
+void (*const clients[])(WayBase*) = {
+    clientCode1<WayBase>, clientCode2<WayBase>, clientCode3<WayBase>,
     //...
-    clientCode18(ptr);
+    clientCode18<WayBase>,
+};
+
+struct Client {  // One client call, bound for the profiler.
+  void (*code)(WayBase*);
+  WayBase* my;
 
-    free(ptr);
-    cout << endl;
+  Client(void (*code)(WayBase*), WayBase* my) : code(code), my(my) {
+  }
+  void operator()() {
+    code(my);
   }
-  cout << endl;
+};
+
+struct Cell {
+  const Way* criteria;
+
+  explicit Cell(const Way* criteria) : criteria(criteria) {
+  }
+  void operator()(size_t i) {
+    const size_t row = COUNT(clients);
+    Way way = criteria[i / row];
+
+    profiler().call(way, Client(clients[i % row], lookup(way)));
+    if (i % row == row - 1) out() << "\n";
+  }
+};
+
+void fanOut(const Way* criteria, size_t count, WorkStealingPool& pool) {
+  pool.runOrdered(count * COUNT(clients), Cell(criteria), out());
+}
+
+void demo(int seqNo) {  // Test all the daughter classes & clients.
+  out() << seqNo << ") << strategy::homework::solution::demo(seqNo) >>\n";
+  Way criteria[] = {Hard, Easy, Quick, Clear};
+  WorkStealingPool pool;
+  fanOut(criteria, COUNT(criteria), pool);
+  out() << endl;
 }
 
 }  // solution
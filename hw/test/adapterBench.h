@@ -0,0 +1,224 @@
+/*
+ * adapterBench.h
+ *
+ * Desc: Benchmarks for the adapter solution (homework::adapter::solution).
+ * Draw output goes to a null sink, so the numbers are mostly dispatch.
+ */
+
+#ifndef TEST_ADAPTERBENCH_H_
+#define TEST_ADAPTERBENCH_H_
+
+namespace adapterBench {
+
+using namespace homework::adapter::solution;
+
+/* N shapes (HW_SHAPE_REFS, default ten million), the demo's six types in
+ * turn, built once: drawn through the interface from a vector of heap
+ * pointers against held by value in a vector of ShapeRefs. Only the draw
+ * loops are timed.
+ */
+BENCH(adapter_shape_ref) {
+  const size_t count = benchSize("HW_SHAPE_REFS", 10000000);
+  vector<ShapeInterfaceDraw*> heap;
+  vector<ShapeRef> refs;
+  heap.reserve(count);
+  refs.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    switch (i % 6) {
+      case 0:
+        heap.push_back(new Point);
+        refs.push_back(ShapeRef(ShapeRef::Make<Point>()));
+        break;
+      case 1:
+        heap.push_back(new Line);
+        refs.push_back(ShapeRef(ShapeRef::Make<Line>()));
+        break;
+      case 2:
+        heap.push_back(new Rect);
+        refs.push_back(ShapeRef(ShapeRef::Make<Rect>()));
+        break;
+      case 3:
+        heap.push_back(new Polygon);
+        refs.push_back(ShapeRef(ShapeRef::Make<commercial::Polygon>()));
+        break;
+      case 4:
+        heap.push_back(new Torus);
+        refs.push_back(ShapeRef(ShapeRef::Make<commercial::Torus>()));
+        break;
+      default:
+        heap.push_back(new Bezel);
+        refs.push_back(ShapeRef(ShapeRef::Make<commercial::Bezel>()));
+    }
+  }
+
+  result("heap pointers, virtual draw", nsPerOp(count, [&] {
+    for (size_t i = 0; i < count; i++) clientCode(heap[i]);
+  }), "ns/shape");
+  result("ShapeRef", nsPerOp(count, [&] {
+    for (size_t i = 0; i < count; i++) refs[i].draw();
+  }), "ns/shape");
+  for (size_t i = 0; i < count; i++) delete heap[i];
+}
+
+void missLine(const string& what, const PerfCounters& perf, size_t shapes) {
+  double misses = perf.perItem(PerfCounters::CacheMisses, shapes);
+  if (misses < 0) {
+    result(what + ", cache misses", "unavailable");
+  } else {
+    result(what + ", cache misses", misses, "per shape");
+  }
+}
+
+/* 600,000 shapes, six types in random order: virtual draws through a
+ * shuffled vector of heap shapes against ShapeStore::drawAll(), with the
+ * cache misses of each where perf events are available.
+ */
+BENCH(adapter_shape_store) {
+  const size_t each = 100000;
+  vector<ShapeInterfaceDraw*> heap;
+  for (size_t i = 0; i < each; i++) {
+    heap.push_back(new Point);
+    heap.push_back(new Line);
+    heap.push_back(new Rect);
+    heap.push_back(new Polygon);
+    heap.push_back(new Torus);
+    heap.push_back(new Bezel);
+  }
+  unsigned seed = 1;
+  for (size_t i = heap.size() - 1; i > 0; i--) {
+    seed = seed * 1103515245 + 12345;
+    swap(heap[i], heap[(seed >> 8) % (i + 1)]);
+  }
+  ShapeStore store;
+  store.add<Point>(each);
+  store.add<Line>(each);
+  store.add<Rect>(each);
+  store.add<Polygon>(each);
+  store.add<Torus>(each);
+  store.add<Bezel>(each);
+
+  PerfCounters perf;
+  perf.start();
+  double virtual_ = nsPerOp(heap.size(), [&] {
+    for (size_t i = 0; i < heap.size(); i++) clientCode(heap[i]);
+  });
+  perf.stop();
+  result("heap, virtual", virtual_, "ns/shape");
+  missLine("heap, virtual", perf, heap.size());
+
+  perf.start();
+  double drawAll = nsPerOp(store.size(), [&] { store.drawAll(); });
+  perf.stop();
+  result("ShapeStore::drawAll", drawAll, "ns/shape");
+  missLine("ShapeStore::drawAll", perf, store.size());
+  for (size_t i = 0; i < heap.size(); i++) delete heap[i];
+}
+
+/* Commercial shapes drawn through a hand-written adapter per element, the
+ * final DisplayAdapter called directly, and a DisplayView over the
+ * commercial objects themselves.
+ */
+BENCH(adapter_display_adapter) {
+  const size_t count = 1000000;
+  vector<Torus> written(count);
+  vector<DisplayAdapter<commercial::Torus> > adapted(count);
+  vector<commercial::Torus> tori(count);
+  vector<commercial::ShapeInterfaceDisplay*> commercialShapes;
+  for (size_t i = 0; i < count; i++) commercialShapes.push_back(&tori[i]);
+  DisplayView view(commercialShapes);
+
+  result("hand-written, virtual", nsPerOp(count, [&] {
+    for (size_t i = 0; i < count; i++) clientCode(&written[i]);
+  }), "ns/shape");
+  result("DisplayAdapter, direct", nsPerOp(count, [&] {
+    for (size_t i = 0; i < count; i++) adapted[i].draw();
+  }), "ns/shape");
+  result("DisplayView::at", nsPerOp(count, [&] {
+    for (size_t i = 0; i < count; i++) clientCode(view.at(i));
+  }), "ns/shape");
+  result("DisplayView::drawAll", nsPerOp(count, [&] {
+    view.drawAll();
+  }), "ns/shape");
+}
+
+/* Draw commands formatted on the drawing thread against handed to a
+ * RenderQueue, and the CPU the queue's consumer uses while idle.
+ */
+BENCH(adapter_render_queue) {
+  const size_t draws = 2000000;
+  NullSink discard;
+  ostream sink(&discard);
+  result("direct", nsPerOp(draws, [&] {
+    for (size_t i = 0; i < draws; i++) emit(DrawCommand(i % 6));
+  }), "ns/draw");
+  {
+    RenderQueue queue(4096, RenderQueue::Block, sink);
+    renderQueue() = &queue;
+    result("queued, producer side", nsPerOp(draws, [&] {
+      for (size_t i = 0; i < draws; i++) emit(DrawCommand(i % 6));
+    }), "ns/draw");
+    renderQueue() = 0;
+
+    clock_t start = clock();
+    this_thread::sleep_for(chrono::milliseconds(100));
+    result("idle consumer", double(clock() - start) / CLOCKS_PER_SEC * 10,
+           "CPU s/s");
+  }
+}
+
+BENCH(adapter_draw_parallel) {  // Scaling with workers, 600,000 shapes.
+  ShapeStore store;
+  store.add<Point>(200000);
+  store.add<Polygon>(200000);
+  store.add<Rect>(200000);
+  vector<ShapeInterfaceDraw*> shapes = store.pointers();
+  result("serial", nsPerOp(shapes.size(), [&] {
+    for (size_t i = 0; i < shapes.size(); i++) clientCode(shapes[i]);
+  }), "ns/shape");
+  unsigned workers[] = {1, 2, 4, 8};
+  for (size_t w = 0; w < COUNT(workers); w++) {
+    WorkStealingPool pool(workers[w]);
+    result(to_string(workers[w]) + " workers", nsPerOp(shapes.size(), [&] {
+      drawParallel(shapes, pool);
+    }), "ns/shape");
+  }
+}
+
+/* Bulk load of a scene of N shapes (HW_SCENE_SHAPES, default a million)
+ * against building the same shapes one new at a time.
+ */
+BENCH(adapter_scene_load) {
+  const size_t count = benchSize("HW_SCENE_SHAPES", 1000000);
+  ScratchFile scratch("hw_bench_scene");
+  const char* path = scratch.path();
+  vector<DrawCommand> scene(count);
+  for (size_t i = 0; i < count; i++) scene[i] = DrawCommand(i % 6);
+  if (!writeScene(path, &scene[0], count)) {
+    result("scene", "could not be written");
+    return;
+  }
+
+  result("new per shape", nsPerOp(count, [&] {
+    vector<ShapeInterfaceDraw*> shapes;
+    shapes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      switch (scene[i]) {
+        case DrawPoint: shapes.push_back(new Point); break;
+        case DrawLine: shapes.push_back(new Line); break;
+        case DrawRect: shapes.push_back(new Rect); break;
+        case DisplayPolygon: shapes.push_back(new Polygon); break;
+        case DisplayTorus: shapes.push_back(new Torus); break;
+        case DisplayBezel: shapes.push_back(new Bezel); break;
+      }
+    }
+    for (size_t i = 0; i < shapes.size(); i++) delete shapes[i];
+  }), "ns/shape");
+  result("loadScene", nsPerOp(count, [&] {
+    ShapeStore store;
+    loadScene(path, store);
+  }), "ns/shape");
+}
+
+}  // adapterBench
+
+#endif /* TEST_ADAPTERBENCH_H_ */
@@ -0,0 +1,214 @@
+/*
+ * adapterTest.h
+ *
+ * Desc: Tests for the adapter solution (homework::adapter::solution).
+ */
+
+#ifndef TEST_ADAPTERTEST_H_
+#define TEST_ADAPTERTEST_H_
+
+namespace adapterTest {
+
+using namespace homework::adapter::solution;
+
+template <class Draw>
+string captureDraws(Draw draw) {
+  ostringstream captured;
+  Redirect redirect(captured);
+  draw();
+  return captured.str();
+}
+
+TEST(adapter_shape_ref_draws_either_interface) {
+  ShapeRef point((ShapeRef::Make<Point>()));
+  ShapeRef torus((ShapeRef::Make<commercial::Torus>()));
+  CHECK(captureDraws([&] { point.draw(); }) == drawText[DrawPoint]);
+  CHECK(captureDraws([&] { torus.draw(); }) == drawText[DisplayTorus]);
+
+  ShapeRef copy(torus);
+  copy = point;
+  CHECK(captureDraws([&] { copy.draw(); }) == drawText[DrawPoint]);
+}
+
+TEST(adapter_shape_ref_allocates_nothing) {
+  AllocationScope scope;
+  {
+    ShapeRef shapes[] = {
+        ShapeRef(ShapeRef::Make<Point>()), ShapeRef(ShapeRef::Make<Rect>()),
+        ShapeRef(ShapeRef::Make<commercial::Polygon>()),
+        ShapeRef(ShapeRef::Make<Bezel>())};
+    for (size_t i = 0; i < COUNT(shapes); i++) shapes[i].draw();
+    ShapeRef copy(shapes[1]);
+    copy = shapes[2];
+    copy.draw();
+  }
+  CHECK(scope.allocations() == 0);
+}
+
+TEST(adapter_shape_store_draws_grouped_by_type) {
+  ShapeStore store;
+  store.add<Torus>();
+  store.add<Point>(2);
+  store.add<Bezel>();
+  CHECK(store.size() == 4);
+  string expected = string(drawText[DrawPoint]) + drawText[DrawPoint] +
+                    drawText[DisplayTorus] + drawText[DisplayBezel];
+  CHECK(captureDraws([&] { store.drawAll(); }) == expected);
+
+  vector<ShapeInterfaceDraw*> all = store.pointers();
+  CHECK(all.size() == 4);
+  CHECK(captureDraws([&] {
+          for (size_t i = 0; i < all.size(); i++) clientCode(all[i]);
+        }) == expected);
+}
+
+TEST(adapter_display_adapter_and_view_match_hand_written_adapters) {
+  DisplayAdapter<commercial::Torus> adapted;
+  Torus written;
+  CHECK(captureDraws([&] { clientCode(&adapted); }) ==
+        captureDraws([&] { clientCode(&written); }));
+
+  commercial::Polygon polygon;
+  commercial::Bezel bezel;
+  vector<commercial::ShapeInterfaceDisplay*> shapes;
+  shapes.push_back(&polygon);
+  shapes.push_back(&bezel);
+  DisplayView view(shapes);
+  CHECK(view.size() == 2);
+  string expected =
+      string(drawText[DisplayPolygon]) + drawText[DisplayBezel];
+  CHECK(captureDraws([&] {
+          for (size_t i = 0; i < view.size(); i++) clientCode(view.at(i));
+        }) == expected);
+  CHECK(captureDraws([&] { view.drawAll(); }) == expected);
+}
+
+size_t lines(const string& text) {
+  return size_t(count(text.begin(), text.end(), '\n'));
+}
+
+TEST(adapter_render_queue_blocks_without_losing_draws) {
+  ostringstream drawn;
+  size_t pushed = 0;
+  {
+    RenderQueue queue(2, RenderQueue::Block, drawn);
+    for (size_t i = 0; i < 20000; i++) {
+      pushed += queue.push(DrawCommand(i % COUNT(drawText)));
+    }
+  }
+  CHECK(pushed == 20000);
+  CHECK(lines(drawn.str()) == 20000);
+  CHECK(drawn.str().compare(0, strlen(drawText[0]), drawText[0]) == 0);
+}
+
+TEST(adapter_render_queue_drop_accounts_for_every_push) {
+  ostringstream drawn;
+  size_t pushed = 0;
+  unsigned long drops;
+  {
+    RenderQueue queue(2, RenderQueue::Drop, drawn);
+    for (size_t i = 0; i < 20000; i++) pushed += queue.push(DrawPoint);
+    drops = queue.drops();
+  }
+  CHECK(pushed + drops == 20000);
+  CHECK(lines(drawn.str()) == pushed);
+}
+
+TEST(adapter_render_queue_idles_without_spinning) {
+  ostringstream drawn;
+  RenderQueue queue(64, RenderQueue::Block, drawn);
+  queue.push(DrawLine);
+  clock_t start = clock();  // Process CPU time, every thread.
+  this_thread::sleep_for(chrono::milliseconds(200));
+  double cpu = double(clock() - start) / CLOCKS_PER_SEC;
+  CHECK(cpu < 0.05);  // A spinning consumer would burn ~0.2 s.
+  CHECK(queue.written() == 1);
+}
+
+TEST(adapter_draw_parallel_keeps_order_past_a_queue) {
+  ShapeStore store;
+  store.add<Point>(3000);
+  store.add<Torus>(3000);
+  store.add<Line>(3000);
+  vector<ShapeInterfaceDraw*> shapes = store.pointers();
+  string serial = captureDraws([&] {
+    for (size_t i = 0; i < shapes.size(); i++) clientCode(shapes[i]);
+  });
+
+  ostringstream queued;
+  RenderQueue queue(64, RenderQueue::Block, queued);
+  renderQueue() = &queue;  // The caller is worker 0; its draws stay ordered.
+  WorkStealingPool pool(4);
+  string parallel = captureDraws([&] { drawParallel(shapes, pool, 100); });
+  renderQueue() = 0;
+
+  CHECK(parallel == serial);
+  CHECK(queue.written() == 0);
+}
+
+TEST(adapter_scene_round_trips) {
+  ScratchFile scratch("hw_test_scene");
+  const char* path = scratch.path();
+  DrawCommand shapes[] = {DisplayBezel, DrawPoint, DrawPoint, DisplayTorus};
+  CHECK(writeScene(path, shapes, COUNT(shapes)));
+  ShapeStore store;
+  CHECK(loadScene(path, store));
+  CHECK(store.size() == COUNT(shapes));
+  CHECK(captureDraws([&] { store.drawAll(); }) ==
+        string(drawText[DrawPoint]) + drawText[DrawPoint] +
+            drawText[DisplayTorus] + drawText[DisplayBezel]);
+}
+
+TEST(adapter_scene_rejects_counts_beyond_the_file) {
+  ScratchFile scratch("hw_test_scene");
+  const char* path = scratch.path();
+  DrawCommand shapes[] = {DrawLine, DrawRect};
+  CHECK(writeScene(path, shapes, COUNT(shapes)));
+  uint64_t counts[] = {3, uint64_t(1) << 58, ~uint64_t(0)};
+  for (size_t i = 0; i < COUNT(counts); i++) {
+    FILE* file = fopen(path, "r+b");
+    fseek(file, offsetof(SceneHeader, count), SEEK_SET);
+    fwrite(&counts[i], sizeof(counts[i]), 1, file);
+    fclose(file);
+
+    ShapeStore store;
+    bool loaded = true;
+    try {
+      loaded = loadScene(path, store);
+    } catch (...) {
+      CHECK(!"loadScene threw");
+    }
+    CHECK(!loaded);
+    CHECK(store.size() == 0);
+  }
+
+  FILE* file = fopen(path, "wb");  // Shorter than a header.
+  fwrite("HWSCENE1", 8, 1, file);
+  fclose(file);
+  ShapeStore store;
+  CHECK(!loadScene(path, store));
+}
+
+TEST(adapter_scene_loads_across_chunks) {
+  ScratchFile scratch("hw_test_scene");
+  const char* path = scratch.path();
+  vector<DrawCommand> shapes(1000);  // Several chunks' worth.
+  for (size_t i = 0; i < shapes.size(); i++) shapes[i] = DrawCommand(i % 6);
+  CHECK(writeScene(path, &shapes[0], shapes.size()));
+  ShapeStore store;
+  CHECK(loadScene(path, store));
+  CHECK(store.size() == shapes.size());
+
+  uint32_t bad = 99;  // A bad tag late in the file adds nothing.
+  FILE* file = fopen(path, "r+b");
+  fseek(file, sizeof(SceneHeader) + 900 * sizeof(SceneRecord), SEEK_SET);
+  fwrite(&bad, sizeof(bad), 1, file);
+  fclose(file);
+  ShapeStore rejected;
+  CHECK(!loadScene(path, rejected));
+  CHECK(rejected.size() == 0);
+}
+
+}  // adapterTest
+
+#endif /* TEST_ADAPTERTEST_H_ */
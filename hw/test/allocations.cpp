@@ -0,0 +1,34 @@
+/*
+ * allocations.cpp
+ *
+ * Desc: Replacement global operator new/delete that feed the counters in
+ * allocations.h.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+#include "test/allocations.h"
+
+void* operator new(size_t size) {
+  allocationCount().fetch_add(1, memory_order_relaxed);
+  allocationBytes().fetch_add(size, memory_order_relaxed);
+  void* p = malloc(size ? size : 1);
+  if (!p) throw bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
@@ -0,0 +1,42 @@
+/*
+ * allocations.h
+ *
+ * Desc: Counts heap allocations made through the global operator new, so
+ * tests and benchmarks can prove a path allocates nothing. The replacement
+ * operators live out of line in allocations.cpp, linked into the test and
+ * bench executables, so the optimizer never pairs an inlined malloc with a
+ * delete expression.
+ */
+
+#ifndef TEST_ALLOCATIONS_H_
+#define TEST_ALLOCATIONS_H_
+
+inline atomic<unsigned long>& allocationCount() {
+  static atomic<unsigned long> count(0);
+  return count;
+}
+
+inline atomic<unsigned long>& allocationBytes() {
+  static atomic<unsigned long> bytes(0);
+  return bytes;
+}
+
+class AllocationScope {  // Allocations made since construction.
+  unsigned long count;
+  unsigned long bytes;
+
+ public:
+  AllocationScope()
+      : count(allocationCount().load()), bytes(allocationBytes().load()) {
+  }
+
+ public:
+  unsigned long allocations() const {
+    return allocationCount().load() - count;
+  }
+  unsigned long allocatedBytes() const {
+    return allocationBytes().load() - bytes;
+  }
+};
+
+#endif /* TEST_ALLOCATIONS_H_ */
@@ -0,0 +1,19 @@
+#include <ctime>
+#include <unordered_map>
+
+#include "homework.h"
+
+#include "test/allocations.h"
+#include "test/bench.h"
+#include "test/perf.h"
+#include "test/scratch.h"
+
+#include "test/sinkBench.h"
+#include "test/strategyBench.h"
+#include "test/adapterBench.h"
+#include "test/factoryMethodBench.h"
+// Seam point - include the next pattern's benchmarks.
+
+int main(int argc, char* args[]) {
+  return runBenches(argc > 1 ? args[1] : "");
+}
@@ -0,0 +1,81 @@
+/*
+ * bench.h
+ *
+ * Desc: Minimal benchmark harness. BENCH(name) registers a benchmark;
+ * each one prints its own result lines through result(), while output
+ * from the code under test is discarded. Build with
+ * CMAKE_BUILD_TYPE=Release for meaningful numbers.
+ */
+
+#ifndef TEST_BENCH_H_
+#define TEST_BENCH_H_
+
+struct BenchCase {
+  const char* name;
+  void (*run)();
+};
+
+inline vector<BenchCase>& benchCases() {
+  static vector<BenchCase> cases;
+  return cases;
+}
+
+struct RegisterBench {
+  RegisterBench(const char* name, void (*run)()) {
+    BenchCase bench = {name, run};
+    benchCases().push_back(bench);
+  }
+};
+
+#define BENCH(name)                                         \
+  void bench_##name();                                      \
+  static RegisterBench registerBench_##name(#name, bench_##name); \
+  void bench_##name()
+
+inline double secondsSince(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+template <class Body>  // Runs body() once; it performs ops operations.
+double nsPerOp(size_t ops, Body body) {
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  body();
+  return secondsSince(start) * 1e9 / (ops ? ops : 1);
+}
+
+inline size_t benchSize(const char* variable, size_t fallback) {
+  const char* value = getenv(variable);  // Lets a run pick its own size.
+  return (value && atol(value) > 0) ? size_t(atol(value)) : fallback;
+}
+
+inline void result(const string& what, double value, const char* unit) {
+  cout << "  " << what << ": " << value << " " << unit << "\n";
+}
+
+inline void result(const string& what, const char* text) {  // Not a number.
+  cout << "  " << what << ": " << text << "\n";
+}
+
+inline int runBenches(const char* filter) {
+  for (size_t i = 0; i < benchCases().size(); i++) {
+    const BenchCase& bench = benchCases()[i];
+    if (!strstr(bench.name, filter)) continue;
+    cout << bench.name << "\n";
+    NullSink discard;  // Output of the code under test.
+    ostream sink(&discard);
+    Redirect redirect(sink);
+    bench.run();
+  }
+  return 0;
+}
+
+/* Keeps the optimizer from discarding a computed scalar. */
+template <class T>
+void keep(T value) {
+  static volatile T sink;
+  sink = value;
+  (void)sink;
+}
+
+#endif /* TEST_BENCH_H_ */
@@ -0,0 +1,69 @@
+/*
+ * check.h
+ *
+ * Desc: Minimal test harness. TEST(name) registers a test, CHECK(cond)
+ * records a failure without stopping the test. Output written to out()
+ * by the code under test is discarded.
+ */
+
+#ifndef TEST_CHECK_H_
+#define TEST_CHECK_H_
+
+struct TestCase {
+  const char* name;
+  void (*run)();
+};
+
+inline vector<TestCase>& testCases() {
+  static vector<TestCase> cases;
+  return cases;
+}
+
+inline int& checkFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+struct RegisterTest {
+  RegisterTest(const char* name, void (*run)()) {
+    TestCase test = {name, run};
+    testCases().push_back(test);
+  }
+};
+
+#define TEST(name)                                      \
+  void test_##name();                                   \
+  static RegisterTest register_##name(#name, test_##name); \
+  void test_##name()
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      cout << "    " << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond \
+           << ") failed\n";                                            \
+      checkFailures()++;                                               \
+    }                                                                  \
+  } while (0)
+
+inline int runTests(const char* filter) {  // Runs tests whose name has filter.
+  int failed = 0;
+  for (size_t i = 0; i < testCases().size(); i++) {
+    const TestCase& test = testCases()[i];
+    if (!strstr(test.name, filter)) continue;
+
+    int before = checkFailures();
+    {
+      NullSink discard;
+      ostream sink(&discard);
+      Redirect redirect(sink);
+      test.run();
+    }
+    bool ok = checkFailures() == before;
+    cout << (ok ? "[ OK ] " : "[FAIL] ") << test.name << "\n";
+    if (!ok) failed++;
+  }
+  cout << failed << " test(s) failed.\n";
+  return failed ? 1 : 0;
+}
+
+#endif /* TEST_CHECK_H_ */
@@ -0,0 +1,328 @@
+/*
+ * factoryMethodBench.h
+ *
+ * Desc: Benchmarks for the factory method solution
+ * (homework::factoryMethod::solution).
+ */
+
+#ifndef TEST_FACTORYMETHODBENCH_H_
+#define TEST_FACTORYMETHODBENCH_H_
+
+namespace factoryMethodBench {
+
+using namespace homework::factoryMethod::solution;
+
+/* Lookup by name in catalogs of 5, 500 and 50,000 registered names: the
+ * sorted catalog's find(), the linear chain of string compares it
+ * replaced, and an unordered_map.
+ */
+BENCH(factory_method_lookup) {
+  const size_t lookups = 200000;
+  size_t sizes[] = {5, 500, 50000};
+  for (size_t s = 0; s < COUNT(sizes); s++) {
+    size_t count = sizes[s];
+    vector<string> names(count);
+    for (size_t i = 0; i < count; i++) names[i] = "format" + to_string(i);
+    sort(names.begin(), names.end());
+    vector<Catalog<Display> > catalog(count);
+    unordered_map<string, Display* (*)()> hashed;
+    for (size_t i = 0; i < count; i++) {
+      Catalog<Display> entry = {names[i].c_str(), make<HDMI, Display>, 0};
+      catalog[i] = entry;
+      hashed[names[i]] = entry.make;
+    }
+    vector<string> wanted(lookups);
+    for (size_t i = 0; i < lookups; i++) {
+      wanted[i] = names[(i * 7919) % count];
+    }
+
+    string n = " of " + to_string(count);
+    result("find()" + n, nsPerOp(lookups, [&] {
+      for (size_t i = 0; i < lookups; i++) {
+        keep(find(&catalog[0], count, wanted[i])->make());
+      }
+    }), "ns/lookup");
+    if (count <= 500) {  // Quadratic in total; skip the largest.
+      result("if/else chain" + n, nsPerOp(lookups, [&] {
+        for (size_t i = 0; i < lookups; i++) {
+          for (size_t j = 0; j < count; j++) {
+            if (wanted[i] == catalog[j].name) {
+              keep(catalog[j].make());
+              break;
+            }
+          }
+        }
+      }), "ns/lookup");
+    }
+    result("unordered_map" + n, nsPerOp(lookups, [&] {
+      for (size_t i = 0; i < lookups; i++) {
+        keep(hashed.find(wanted[i])->second());
+      }
+    }), "ns/lookup");
+  }
+}
+
+/* Setting up the demo's 20 streams: the old way, a new crypto per
+ * combination deleted afterwards, against the interned instances.
+ */
+BENCH(factory_method_stream_setup) {
+  const size_t rounds = 20000;
+  string displays[] = {"DisplayPort", "HDMI", "MIPI", "Widi", "HEVC"};
+  string cryptos[] = {"PVP", "ID1", "RSA", "RDX"};
+  size_t streams = rounds * COUNT(displays) * COUNT(cryptos);
+
+  size_t before = allocationCount();
+  double fresh = nsPerOp(streams, [&] {
+    for (size_t r = 0; r < rounds; r++) {
+      for (size_t i = 0; i < COUNT(displays); i++) {
+        Display* display = new HDMI;
+        vector<Crypto*> all;
+        all.push_back(new PVP);
+        all.push_back(new ID1);
+        all.push_back(new RSA);
+        all.push_back(new RDX);
+        for (size_t j = 0; j < all.size(); j++) keep(all[j]);
+        for (size_t j = 0; j < all.size(); j++) delete all[j];
+        delete display;
+      }
+    }
+  });
+  double freshAllocations = double(allocationCount() - before) / streams;
+
+  before = allocationCount();
+  double interned = nsPerOp(streams, [&] {
+    for (size_t r = 0; r < rounds; r++) {
+      for (size_t i = 0; i < COUNT(displays); i++) {
+        Display* display = Display::makeObject(displays[i]);
+        keep(display);
+        for (size_t j = 0; j < COUNT(cryptos); j++) {
+          keep(Crypto::makeObject(cryptos[j]));
+        }
+      }
+    }
+  });
+  double internedAllocations = double(allocationCount() - before) / streams;
+
+  result("new per stream", fresh, "ns/stream");
+  result("new per stream", freshAllocations, "allocations/stream");
+  result("interned", interned, "ns/stream");
+  result("interned", internedAllocations, "allocations/stream");
+}
+
+BENCH(factory_method_pack) {  // Display stage alone, 1080p frames.
+  const int frames = 20;
+  FramePool pool(1920, 1080, 1);
+  for (size_t i = 0; i < COUNT(displayCatalog); i++) {
+    Display* display = displayCatalog[i].make();
+    FrameRef frame = pool.acquire();
+    double ns = 0;
+    for (int n = 0; n < frames; n++) {
+      frame->generate(n);
+      ns += nsPerOp(1, [&] { display->pack(*frame); });
+    }
+    result(string(display->format()) + " pack",
+           frame->bytes() * frames / ns, "GB/sec");
+    result(string(display->format()) + " payload",
+           double(frame->payload) / frame->bytes(), "of the frame");
+  }
+}
+
+/* The cipher over 1 MB at each crypto's round count with each kernel the
+ * CPU supports, in GB/sec and in time stamp counter bytes per cycle (x86
+ * only).
+ */
+BENCH(factory_method_chacha) {
+  const size_t size = 1 << 20;
+  const int passes = 8;
+  vector<uint8_t> data(size, 0x5A);
+  const uint32_t nonce[3] = {0, 0, 0};
+  unsigned rounds[] = {8, 12, 20};
+  for (size_t r = 0; r < COUNT(rounds); r++) {
+    ChaCha chacha("bench", rounds[r]);
+    for (int k = 0; k < ChaCha::Kernels; k++) {
+      ChaCha::Kernel kernel = ChaCha::Kernel(k);
+      if (!ChaCha::supports(kernel)) continue;
+      unsigned long long start = cycleCount();
+      double ns = nsPerOp(size * passes, [&] {
+        for (int p = 0; p < passes; p++) {
+          chacha.apply(&data[0], size, nonce, 0, kernel);
+        }
+      });
+      double cycles = double(cycleCount() - start) / (size * passes);
+      string name = "ChaCha" + to_string(rounds[r]) + ", " +
+                    ChaCha::name(kernel);
+      result(name, 1 / ns, "GB/sec");
+      if (cycles > 0) result(name, 1 / cycles, "bytes/cycle");
+    }
+  }
+}
+
+/* Unpaced streams at 640x480 on every core, in frames per second of wall
+ * time across all streams; then four paced 60 frames/sec streams, in
+ * frames delivered per second against what their work could sustain.
+ */
+BENCH(factory_method_stream_engine) {
+  const int frames = 8;
+  size_t counts[] = {1, 4, 20};
+  WorkStealingPool pool;
+  for (size_t c = 0; c < COUNT(counts); c++) {
+    StreamEngine engine;
+    for (size_t i = 0; i < counts[c]; i++) {
+      size_t d = i % COUNT(displayCatalog);
+      size_t k = i / COUNT(displayCatalog) % COUNT(cryptoCatalog);
+      StreamConfig stream = {displayCatalog[d].make(), cryptoCatalog[k].make(),
+                             60, {640, 480}};
+      engine.add(stream);
+    }
+    double ns = nsPerOp(counts[c] * frames, [&] { engine.run(frames, pool); });
+    result(to_string(counts[c]) + " streams, unpaced", 1e9 / ns,
+           "frames/sec");
+  }
+
+  StreamEngine engine;
+  for (size_t i = 0; i < 4; i++) {
+    StreamConfig stream = {displayCatalog[i].make(), cryptoCatalog[i].make(),
+                           60, {640, 480}};
+    engine.add(stream);
+  }
+  const vector<StreamStats>& stats = engine.run(30, pool, true);
+  double delivered = 0, capacity = 0;
+  for (size_t i = 0; i < stats.size(); i++) {
+    delivered += stats[i].deliveredPerSec;
+    capacity += stats[i].capacityPerSec;
+  }
+  result("4 streams, paced, delivered", delivered, "frames/sec");
+  result("4 streams, paced, capacity", capacity, "frames/sec");
+}
+
+/* Three stages (generate, pack, encrypt) over 1080p frames: pooled frames
+ * handed on by reference against a fresh buffer per stage with the frame
+ * copied into it, the way a copy-per-handoff pipeline would.
+ */
+BENCH(factory_method_frame_pool) {
+  const int frames = 10;
+  Display* display = Display::makeObject("DisplayPort");
+  Crypto* crypto = Crypto::makeObject("RSA");
+  int res[] = {1920, 1080};
+
+  size_t count = allocationCount(), bytes = allocationBytes();
+  double moved = 0;  // Bytes copied between stages.
+  double copied = nsPerOp(frames, [&] {
+    for (int n = 0; n < frames; n++) {
+      FramePool source(res[0], res[1], 1);
+      FrameRef generated = source.acquire();
+      generated->generate(n);
+      FramePool packing(res[0], res[1], 1);
+      FrameRef packed = packing.acquire();
+      memcpy(packed->pixels, generated->pixels, generated->bytes());
+      moved += generated->bytes();
+      packed->number = n, packed->payload = generated->payload;
+      display->pack(*packed);
+      FramePool encrypting(res[0], res[1], 1);
+      FrameRef encrypted = encrypting.acquire();
+      memcpy(encrypted->pixels, packed->pixels, packed->payload);
+      moved += packed->payload;
+      encrypted->number = n, encrypted->payload = packed->payload;
+      crypto->transform(*encrypted);
+    }
+  });
+  double copiedCount = double(allocationCount() - count) / frames;
+  double copiedBytes = double(allocationBytes() - bytes) / frames;
+
+  FramePool pool(res[0], res[1], 2);
+  count = allocationCount(), bytes = allocationBytes();
+  double pooled = nsPerOp(frames, [&] {
+    for (int n = 0; n < frames; n++) {
+      FrameRef frame = pool.acquire();
+      frame->generate(n);
+      FrameRef packed = frame;
+      display->pack(*packed);
+      FrameRef encrypted = packed;
+      crypto->transform(*encrypted);
+    }
+  });
+  double pooledCount = double(allocationCount() - count) / frames;
+  double pooledBytes = double(allocationBytes() - bytes) / frames;
+
+  double frameBytes = double(res[0]) * res[1] * 4;
+  result("copy per stage", copied * 1e-6, "ms/frame");
+  result("copy per stage", copiedCount, "allocations/frame");
+  result("copy per stage", copiedBytes / frameBytes, "frames allocated/frame");
+  result("copy per stage", moved / frames * 1e-6, "MB copied/frame");
+  result("pooled", pooled * 1e-6, "ms/frame");
+  result("pooled", pooledCount, "allocations/frame");
+  result("pooled", pooledBytes / frameBytes, "frames allocated/frame");
+}
+
+BENCH(factory_method_client_code) {  // Identity API on the hot path.
+  const size_t calls = 200000;
+  NullSink discard;
+  ostream sink(&discard);
+  Redirect redirect(sink);
+  int res[] = {1920, 1080};
+  Display* display = Display::makeObject("HEVC");
+  Crypto* crypto = Crypto::makeObject("RDX");
+  size_t before = allocationCount();
+  double ns = nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) clientCode(60, res, display, crypto);
+  });
+  double allocations = double(allocationCount() - before) / calls;
+  result("clientCode", ns, "ns/call");
+  result("clientCode", allocations, "allocations/call");
+}
+
+/* Admission over 2,000 displays and 2,000 cryptos with assorted budgets:
+ * the matrix's bit tests against working out the bandwidth and comparing
+ * it with both budgets on every check.
+ */
+BENCH(factory_method_admission) {
+  const size_t products = 2000;
+  const size_t checks = 4000000;
+  vector<Catalog<Display> > displays(products);
+  vector<Catalog<Crypto> > cryptos(products);
+  for (size_t i = 0; i < products; i++) {
+    Catalog<Display> display = {"", make<HDMI, Display>, 1.0 + i % 50};
+    Catalog<Crypto> crypto = {"", make<RSA, Crypto>, double(i % 7) * 4};
+    displays[i] = display;
+    cryptos[i] = crypto;
+  }
+
+  CapabilityMatrix* matrix = 0;
+  result("build", nsPerOp(1, [&] {
+    matrix = new CapabilityMatrix(&displays[0], products, &cryptos[0],
+                                  products);
+  }) * 1e-3, "us");
+  result("matrix", double(matrix->bytes()), "bytes");
+  result("full D x C x R x F bitset would be",
+         double(products) * products * COUNT(resolutions) *
+             COUNT(framerates) / 8,
+         "bytes");
+
+  size_t admitted = 0;
+  unsigned seed = 99;
+  result("bit tests", nsPerOp(checks, [&] {
+    for (size_t i = 0; i < checks; i++) {
+      seed = seed * 1103515245 + 12345;
+      admitted += matrix->supported(seed % products, (seed >> 11) % products,
+                                    (seed >> 3) % 3, (seed >> 5) % 5);
+    }
+  }), "ns/check");
+  seed = 99;
+  result("computed", nsPerOp(checks, [&] {
+    for (size_t i = 0; i < checks; i++) {
+      seed = seed * 1103515245 + 12345;
+      size_t r = (seed >> 3) % 3, f = (seed >> 5) % 5;
+      double gbps = double(resolutions[r][0]) * resolutions[r][1] *
+                    bitsPerPixel * framerates[f] * 1e-9;
+      double display = displays[seed % products].gbps;
+      double crypto = cryptos[(seed >> 11) % products].gbps;
+      admitted += gbps <= display && (crypto <= 0 || gbps <= crypto);
+    }
+  }), "ns/check");
+  keep(admitted);
+  delete matrix;
+}
+
+}  // factoryMethodBench
+
+#endif /* TEST_FACTORYMETHODBENCH_H_ */
@@ -0,0 +1,400 @@
+/*
+ * factoryMethodTest.h
+ *
+ * Desc: Tests for the factory method solution
+ * (homework::factoryMethod::solution).
+ */
+
+#ifndef TEST_FACTORYMETHODTEST_H_
+#define TEST_FACTORYMETHODTEST_H_
+
+namespace factoryMethodTest {
+
+using namespace homework::factoryMethod::solution;
+
+TEST(factory_method_lookup_finds_every_registered_name) {
+  for (size_t i = 0; i < COUNT(displayCatalog); i++) {
+    Display* display = Display::makeObject(displayCatalog[i].name);
+    CHECK(!strcmp(display->format(), (string(displayCatalog[i].name) +
+                                      "()").c_str()));
+    CHECK(idOf(displayCatalog, COUNT(displayCatalog),
+               displayCatalog[i].name) == i);
+  }
+  for (size_t i = 0; i < COUNT(cryptoCatalog); i++) {
+    Crypto* crypto = Crypto::makeObject(cryptoCatalog[i].name);
+    CHECK(!strcmp(crypto->protocol(), (string(cryptoCatalog[i].name) +
+                                       "()").c_str()));
+  }
+  CHECK(typeid(*Display::makeObject("VGA")) == typeid(Display));
+  CHECK(typeid(*Crypto::makeObject("")) == typeid(Crypto));
+  CHECK(idOf(cryptoCatalog, COUNT(cryptoCatalog), "DES") ==
+        COUNT(cryptoCatalog));
+}
+
+TEST(factory_method_lookup_allocates_nothing) {
+  string names[] = {"DisplayPort", "HDMI", "MIPI", "Widi", "HEVC", "VGA"};
+  string protocols[] = {"PVP", "ID1", "RSA", "RDX", "DES"};
+  Display::makeObject(names[0]);  // Builds the shared instances.
+  Crypto::makeObject(protocols[0]);
+  AllocationScope scope;
+  for (size_t i = 0; i < COUNT(names); i++) Display::makeObject(names[i]);
+  for (size_t i = 0; i < COUNT(protocols); i++) {
+    Crypto::makeObject(protocols[i]);
+  }
+  CHECK(scope.allocations() == 0);
+}
+
+TEST(factory_method_stream_setup_shares_instances_and_allocates_nothing) {
+  string displays[] = {"DisplayPort", "HDMI", "MIPI", "Widi", "HEVC"};
+  string cryptos[] = {"PVP", "ID1", "RSA", "RDX"};
+  StreamConfig first = {Display::makeObject(displays[0]),
+                        Crypto::makeObject(cryptos[0]), 60, {1920, 1080}};
+  for (size_t i = 0; i < COUNT(displays); i++) Display::makeObject(displays[i]);
+  for (size_t j = 0; j < COUNT(cryptos); j++) Crypto::makeObject(cryptos[j]);
+
+  AllocationScope scope;
+  StreamConfig streams[COUNT(displays) * COUNT(cryptos)];
+  for (int round = 0; round < 10; round++) {
+    for (size_t i = 0; i < COUNT(displays); i++) {
+      for (size_t j = 0; j < COUNT(cryptos); j++) {
+        StreamConfig& stream = streams[i * COUNT(cryptos) + j];
+        stream.display = Display::makeObject(displays[i]);
+        stream.crypto = Crypto::makeObject(cryptos[j]);
+        stream.framerate = 60;
+        stream.res[0] = 1920, stream.res[1] = 1080;
+      }
+    }
+  }
+  CHECK(scope.allocations() == 0);
+  CHECK(streams[0].display == first.display);
+  CHECK(streams[0].crypto == first.crypto);
+  CHECK(streams[COUNT(cryptos)].crypto == first.crypto);
+}
+
+string packed(Display* display) {  // One 16x4 frame through pack().
+  FramePool pool(16, 4, 1);
+  FrameRef frame = pool.acquire();
+  frame->generate(3);
+  display->pack(*frame);
+  return string(reinterpret_cast<char*>(frame->pixels), frame->payload);
+}
+
+TEST(factory_method_displays_pack_differently) {
+  string raw = packed(Display::makeObject("VGA"));
+  CHECK(raw.size() == 16 * 4 * 4);
+  set<string> seen;
+  seen.insert(raw);
+  for (size_t i = 0; i < COUNT(displayCatalog); i++) {
+    seen.insert(packed(displayCatalog[i].make()));
+  }
+  CHECK(seen.size() == COUNT(displayCatalog) + 1);
+
+  string bgra = packed(Display::makeObject("DisplayPort"));
+  CHECK(bgra[0] == raw[2] && bgra[2] == raw[0] && bgra[1] == raw[1]);
+  CHECK(packed(Display::makeObject("MIPI")).size() == raw.size() / 2);
+  CHECK(packed(Display::makeObject("Widi")).size() == raw.size() / 4 * 3);
+  CHECK(packed(Display::makeObject("HDMI")).size() == raw.size());
+}
+
+TEST(factory_method_pipeline_report_covers_every_pair) {
+  ostringstream report;
+  int res[] = {32, 16};
+  pipelineReport(report, 60, res, 2);
+  string text = report.str();
+  CHECK(size_t(count(text.begin(), text.end(), '\n')) ==
+        COUNT(displayCatalog) * COUNT(cryptoCatalog));
+  CHECK(text.find("MIPI() via RDX() with [32, 16]") != string::npos);
+}
+
+TEST(factory_method_chacha20_matches_rfc8439_vector) {  // Section 2.4.2.
+  uint32_t key[8];
+  for (uint32_t w = 0; w < 8; w++) {
+    key[w] = (4 * w) | (4 * w + 1) << 8 | (4 * w + 2) << 16 | (4 * w + 3) << 24;
+  }
+  const uint32_t nonce[3] = {0, 0x4a000000, 0};
+  const char* plaintext =
+      "Ladies and Gentlemen of the class of '99: If I could offer you only "
+      "one tip for the future, sunscreen would be it.";
+  const uint8_t expected[] = {
+      0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 0x41, 0xba, 0x07, 0x28,
+      0xdd, 0x0d, 0x69, 0x81, 0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2,
+      0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b, 0xf9, 0x1b, 0x65, 0xc5,
+      0x52, 0x47, 0x33, 0xab, 0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57,
+      0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 0x8f, 0x53, 0x0c, 0x35,
+      0x9f, 0x08, 0x61, 0xd8, 0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61,
+      0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e, 0x52, 0xbc, 0x51, 0x4d,
+      0x16, 0xcc, 0xf8, 0x06, 0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36,
+      0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 0xb4, 0x0b, 0x8e, 0xed,
+      0xf2, 0x78, 0x5e, 0x42, 0x87, 0x4d};
+  CHECK(strlen(plaintext) == sizeof(expected));
+
+  ChaCha chacha(key, 20);
+  for (int k = 0; k < ChaCha::Kernels; k++) {
+    ChaCha::Kernel kernel = ChaCha::Kernel(k);
+    if (!ChaCha::supports(kernel)) continue;
+    vector<uint8_t> data(1024);  // Long enough for a whole SIMD pass.
+    memcpy(&data[0], plaintext, strlen(plaintext));
+    chacha.apply(&data[0], data.size(), nonce, 1, kernel);
+    CHECK(!memcmp(&data[0], expected, sizeof(expected)));
+    chacha.apply(&data[0], data.size(), nonce, 1, kernel);
+    CHECK(!memcmp(&data[0], plaintext, strlen(plaintext)));
+  }
+}
+
+TEST(factory_method_chacha_kernels_match_the_scalar_reference) {
+  uint32_t seed = 2463534242u;  // xorshift32.
+  struct {
+    uint32_t* seed;
+    uint32_t operator()() {
+      *seed ^= *seed << 13, *seed ^= *seed >> 17, *seed ^= *seed << 5;
+      return *seed;
+    }
+  } random = {&seed};
+
+  for (int trial = 0; trial < 50; trial++) {
+    uint32_t key[8], nonce[3];
+    for (size_t w = 0; w < 8; w++) key[w] = random();
+    for (size_t w = 0; w < 3; w++) nonce[w] = random();
+    uint32_t counter = trial ? random() : ~0u - 3;  // Once across the wrap.
+    ChaCha chacha(key, 8 + 4 * (trial % 4));
+    vector<uint8_t> reference(random() % 2000);
+    for (size_t i = 0; i < reference.size(); i++) {
+      reference[i] = uint8_t(random());
+    }
+    vector<uint8_t> data(reference);
+    chacha.apply(reference.data(), reference.size(), nonce, counter,
+                 ChaCha::Scalar);
+
+    for (int k = ChaCha::Scalar + 1; k < ChaCha::Kernels; k++) {
+      ChaCha::Kernel kernel = ChaCha::Kernel(k);
+      if (!ChaCha::supports(kernel)) continue;
+      vector<uint8_t> simd(data);
+      chacha.apply(simd.data(), simd.size(), nonce, counter, kernel);
+      CHECK(simd == reference);
+    }
+  }
+}
+
+struct CountingClock : public PacerClock {  // Most streams asleep at once.
+  mutex lock;
+  int sleeping;
+  int most;
+
+  CountingClock() : sleeping(0), most(0) {
+  }
+  virtual void sleepUntil(Time when) {
+    {
+      lock_guard<mutex> hold(lock);
+      most = max(most, ++sleeping);
+    }
+    PacerClock::sleepUntil(when);
+    lock_guard<mutex> hold(lock);
+    sleeping--;
+  }
+};
+
+TEST(factory_method_paced_streams_get_a_thread_each) {
+  StreamEngine engine;
+  for (size_t j = 0; j < 3; j++) {
+    StreamConfig stream = {Display::makeObject("MIPI"),
+                           cryptoCatalog[j].make(), 50, {16, 16}};
+    engine.add(stream);
+  }
+  WorkStealingPool one(1);
+  CountingClock clock;
+  const vector<StreamStats>& stats =
+      engine.run(10, one, true, Pacer::Deliver, &clock);
+
+  CHECK(stats.size() == 3);
+  CHECK(clock.most == 3);  // Side by side; one thread would never pass 1.
+  for (size_t i = 0; i < stats.size(); i++) {
+    CHECK(engine.pacer(i).delivered == 10);
+  }
+}
+
+TEST(factory_method_frame_pool_shares_and_recycles_frames) {
+  FramePool pool(8, 8, 1);
+  {
+    FrameRef first = pool.acquire();
+    CHECK(bool(first));
+    FrameRef handedOn = first;  // Same pixels, no copy.
+    CHECK(handedOn->pixels == first->pixels);
+    CHECK(!pool.acquire());  // Dry while any handle holds the frame.
+    first = FrameRef();
+    CHECK(!pool.acquire());
+  }
+  CHECK(bool(pool.acquire()));  // Back once the last handle let go.
+  CHECK(pool.acquired() == 2);
+}
+
+TEST(factory_method_frame_pool_steady_state_allocates_nothing) {
+  FramePool pool(64, 48, 2);
+  Display* display = Display::makeObject("HDMI");
+  Crypto* crypto = Crypto::makeObject("RSA");
+  AllocationScope scope;
+  for (int n = 0; n < 20; n++) {
+    FrameRef frame = pool.acquire();
+    CHECK(bool(frame));
+    frame->generate(n);
+    FrameRef packStage = frame;
+    display->pack(*packStage);
+    FrameRef cryptoStage = packStage;
+    crypto->transform(*cryptoStage);
+  }
+  CHECK(scope.allocations() == 0);
+}
+
+struct ManualClock : public PacerClock {  // Time moves only when told.
+  Time time;
+
+  virtual Time now() {
+    return time;
+  }
+  virtual void sleepUntil(Time when) {
+    if (time < when) time = when;
+  }
+  void advance(chrono::microseconds by) {
+    time += by;
+  }
+};
+
+TEST(factory_method_pacer_sheds_only_frames_it_never_processed) {
+  ManualClock clock;
+  Pacer pacer(1000, Pacer::Drop, &clock);  // 1 ms period.
+  CHECK(pacer.wait() == 0);
+  clock.advance(chrono::microseconds(5500));  // A slow frame.
+  CHECK(!pacer.deliver());
+  CHECK(pacer.delivered == 1 && pacer.missed == 1 && pacer.dropped == 0);
+
+  CHECK(pacer.wait() == 4);  // Frames 1-4 are already overdue.
+  CHECK(pacer.dropped == 4);
+  CHECK(pacer.deliver());  // Back on schedule.
+  CHECK(pacer.delivered == 2 && pacer.missed == 1);
+  CHECK(pacer.wait(0) == 0);
+}
+
+TEST(factory_method_pacer_deliver_policy_never_sheds) {
+  ManualClock clock;
+  Pacer pacer(1000, Pacer::Deliver, &clock);
+  pacer.wait();
+  clock.advance(chrono::microseconds(5500));
+  pacer.deliver();
+  CHECK(pacer.wait() == 0);
+  pacer.deliver();
+  CHECK(pacer.dropped == 0 && pacer.delivered == 2 && pacer.missed == 2);
+}
+
+struct Stall : public Display {  // A display stage that takes a while.
+  ManualClock* clock;
+  chrono::microseconds takes;
+
+  Stall(ManualClock* clock, chrono::microseconds takes)
+      : clock(clock), takes(takes) {
+  }
+  virtual void pack(Frame&) {
+    clock->advance(takes);
+  }
+};
+
+TEST(factory_method_paced_stream_accounts_for_every_frame) {
+  ManualClock clock;
+  Stall stall(&clock, chrono::microseconds(25000));
+  StreamEngine engine;
+  StreamConfig stream = {&stall, Crypto::makeObject("RSA"), 100, {8, 8}};
+  engine.add(stream);
+  WorkStealingPool pool(1);
+  const vector<StreamStats>& stats =
+      engine.run(30, pool, true, Pacer::Drop, &clock);
+  const Pacer& pacer = engine.pacer(0);
+  CHECK(pacer.delivered + pacer.dropped == 30);
+  CHECK(pacer.delivered == 12);  // Two in every five 10 ms slots.
+  CHECK(pacer.missed == 12);
+  CHECK(stats[0].maxMs > 24.9 && stats[0].maxMs < 25.1);
+}
+
+TEST(factory_method_paced_stream_reports_delivered_and_capacity) {
+  ManualClock clock;
+  Stall stall(&clock, chrono::microseconds(1000));
+  StreamEngine engine;
+  StreamConfig stream = {&stall, Crypto::makeObject("RSA"), 100, {8, 8}};
+  engine.add(stream);
+  WorkStealingPool pool(1);
+  const vector<StreamStats>& stats =
+      engine.run(10, pool, true, Pacer::Deliver, &clock);
+  CHECK(stats[0].capacityPerSec > 999 && stats[0].capacityPerSec < 1001);
+  double delivered = 10 / 0.091;  // Ten frames, the last done at 91 ms.
+  CHECK(stats[0].deliveredPerSec > delivered - 0.1 &&
+        stats[0].deliveredPerSec < delivered + 0.1);
+}
+
+TEST(factory_method_client_code_writes_to_out) {
+  int res[] = {1920, 1080};
+  Display* display = Display::makeObject("MIPI");
+  Crypto* crypto = Crypto::makeObject("RSA");
+  ostringstream captured;
+  {
+    Redirect redirect(captured);
+    clientCode(60, res, display, crypto);
+  }
+  CHECK(captured.str() == string("  Display ") + display->format() +
+                              " at 60 frames/sec with [1920, 1080] via " +
+                              crypto->protocol() + ".\n");
+}
+
+TEST(factory_method_client_code_allocates_nothing) {
+  NullSink discard;
+  ostream sink(&discard);
+  Redirect redirect(sink);
+  int res[] = {1920, 1080};
+  clientCode(60, res, displayCatalog[0].make(), cryptoCatalog[0].make());
+
+  AllocationScope scope;
+  for (size_t i = 0; i < COUNT(displayCatalog); i++) {
+    for (size_t j = 0; j < COUNT(cryptoCatalog); j++) {
+      clientCode(60, res, displayCatalog[i].make(), cryptoCatalog[j].make());
+    }
+  }
+  CHECK(scope.allocations() == 0);
+}
+
+bool fits(double gbps, double limit) {
+  return limit <= 0 || gbps <= limit;
+}
+
+TEST(factory_method_capabilities_match_the_catalog_budgets) {
+  const CapabilityMatrix& matrix = capabilities();
+  size_t modes = COUNT(resolutions) * COUNT(framerates);
+  size_t rows = COUNT(displayCatalog) + COUNT(cryptoCatalog);
+  CHECK(matrix.bytes() == (rows * modes + 63) / 64 * sizeof(uint64_t));
+  for (size_t d = 0; d < COUNT(displayCatalog); d++) {
+    for (size_t c = 0; c < COUNT(cryptoCatalog); c++) {
+      for (size_t r = 0; r < COUNT(resolutions); r++) {
+        for (size_t f = 0; f < COUNT(framerates); f++) {
+          double gbps = matrix.bandwidthGbps(r, f);
+          CHECK(matrix.supported(d, c, r, f) ==
+                (fits(gbps, displayCatalog[d].gbps) &&
+                 fits(gbps, cryptoCatalog[c].gbps)));
+        }
+      }
+    }
+  }
+  size_t widi = idOf(displayCatalog, COUNT(displayCatalog), "Widi");
+  CHECK(matrix.supported(widi, 0, 1, 2));    // 1080p60 is 2.99 Gbit/s.
+  CHECK(!matrix.supported(widi, 0, 2, 2));   // 2160p60 is 11.9 Gbit/s.
+  CHECK(!matrix.supported(COUNT(displayCatalog), 0, 0, 0));
+  CHECK(!matrix.supported(0, 0, COUNT(resolutions), 0));
+  CHECK(matrix.bandwidthGbps(COUNT(resolutions), 0) == 0);
+  CHECK(matrix.bandwidthGbps(0, COUNT(framerates)) == 0);
+}
+
+TEST(factory_method_capabilities_respect_crypto_rates) {
+  const Catalog<Crypto> slow[] = {{"Slow", make<Crypto, Crypto>, 1.0}};
+  CapabilityMatrix matrix(displayCatalog, COUNT(displayCatalog), slow, 1);
+  size_t hevc = idOf(displayCatalog, COUNT(displayCatalog), "HEVC");
+  CHECK(matrix.supported(hevc, 0, 0, 0));   // 480p48 is 0.35 Gbit/s.
+  CHECK(!matrix.supported(hevc, 0, 1, 0));  // 1080p48 is 2.39 Gbit/s.
+}
+
+}  // factoryMethodTest
+
+#endif /* TEST_FACTORYMETHODTEST_H_ */
@@ -0,0 +1,100 @@
+/*
+ * perf.h
+ *
+ * Desc: Hardware counters for benchmarks (Linux perf events): instructions,
+ * branch misses and cache misses for the calling thread. Where counters are
+ * unavailable (other platforms, or perf_event_paranoid) reads give -1.
+ * cycleCount() reads the x86 time stamp counter, and is 0 elsewhere.
+ */
+
+#ifndef TEST_PERF_H_
+#define TEST_PERF_H_
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+inline unsigned long long cycleCount() {  // Reference cycles on x86.
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+class PerfCounters {
+ public:
+  enum Event { Instructions, BranchMisses, CacheMisses, Events };
+
+ private:
+  int fds[Events];
+  long long values[Events];
+
+ public:
+  PerfCounters() {
+    for (int e = 0; e < Events; e++) fds[e] = open(Event(e)), values[e] = -1;
+  }
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int e = 0; e < Events; e++) {
+      if (fds[e] >= 0) close(fds[e]);
+    }
+#endif
+  }
+
+ public:
+  void start() {
+#ifdef __linux__
+    for (int e = 0; e < Events; e++) {
+      if (fds[e] < 0) continue;
+      ioctl(fds[e], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fds[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+  void stop() {
+    for (int e = 0; e < Events; e++) {
+      values[e] = -1;
+#ifdef __linux__
+      if (fds[e] < 0) continue;
+      ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+      long long value;
+      if (read(fds[e], &value, sizeof(value)) == sizeof(value)) {
+        values[e] = value;
+      }
+#endif
+    }
+  }
+  double perItem(Event e, size_t items) const {  // -1 if unavailable.
+    return values[e] < 0 ? -1 : double(values[e]) / (items ? items : 1);
+  }
+
+ private:
+  static int open(Event e) {
+#ifdef __linux__
+    static const unsigned long long configs[] = {
+        PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_MISSES};
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[e];
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+    (void)e;
+    return -1;
+#endif
+  }
+};
+
+#endif /* TEST_PERF_H_ */
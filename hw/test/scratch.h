@@ -0,0 +1,50 @@
+/*
+ * scratch.h
+ *
+ * Desc: Uniquely named scratch files for tests and benchmarks, so runs
+ * in parallel or from a read-only working directory do not collide.
+ */
+
+#ifndef TEST_SCRATCH_H_
+#define TEST_SCRATCH_H_
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+class ScratchFile {  // Created empty, removed on destruction.
+  string name;
+
+ public:
+  explicit ScratchFile(const char* prefix) {
+#if defined(__unix__) || defined(__APPLE__)
+    const char* dir = getenv("TMPDIR");
+    string pattern = string(dir && *dir ? dir : "/tmp") + "/" + prefix +
+                     ".XXXXXX";
+    vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    int fd = mkstemp(&path[0]);
+    if (fd >= 0) {
+      close(fd);
+      name = &path[0];
+    }
+#else
+    char path[L_tmpnam];
+    if (tmpnam(path)) name = path;
+#endif
+  }
+  ~ScratchFile() {
+    if (!name.empty()) remove(name.c_str());
+  }
+
+ private:
+  ScratchFile(const ScratchFile&);
+  ScratchFile& operator=(const ScratchFile&);
+
+ public:
+  const char* path() const {  // Empty if no file could be made.
+    return name.c_str();
+  }
+};
+
+#endif /* TEST_SCRATCH_H_ */
@@ -0,0 +1,51 @@
+/*
+ * sinkBench.h
+ *
+ * Desc: Benchmarks for the output sinks (sink.h): a line per call to a
+ * file, flushed by endl each time, buffered until the batch ends, and
+ * discarded.
+ */
+
+#ifndef TEST_SINKBENCH_H_
+#define TEST_SINKBENCH_H_
+
+namespace sinkBench {
+
+template <class Line>
+double linesTo(ostream& to, size_t lines, Line line) {
+  return nsPerOp(lines, [&] {
+    for (size_t i = 0; i < lines; i++) line(to, i);
+    to.flush();
+  });
+}
+
+BENCH(sink_lines) {
+  const size_t lines = 200000;
+  const char* path = "hw_bench_sink.tmp";
+  auto flushed = [](ostream& to, size_t i) {
+    to << "The hard way." << i << endl;
+  };
+  auto plain = [](ostream& to, size_t i) {
+    to << "The hard way." << i << "\n";
+  };
+  {
+    ofstream file(path);
+    result("file, endl", linesTo(file, lines, flushed), "ns/line");
+  }
+  {
+    ofstream file(path);
+    BufferedSink buffered(file.rdbuf());
+    ostream to(&buffered);
+    result("file, buffered", linesTo(to, lines, plain), "ns/line");
+  }
+  {
+    NullSink discard;
+    ostream to(&discard);
+    result("null sink", linesTo(to, lines, plain), "ns/line");
+  }
+  remove(path);
+}
+
+}  // sinkBench
+
+#endif /* TEST_SINKBENCH_H_ */
@@ -0,0 +1,53 @@
+/*
+ * sinkTest.h
+ *
+ * Desc: Tests for the output sinks (sink.h).
+ */
+
+#ifndef TEST_SINKTEST_H_
+#define TEST_SINKTEST_H_
+
+namespace sinkTest {
+
+TEST(sink_redirect_is_scoped_and_per_thread) {
+  ostringstream outer, inner;
+  {
+    Redirect first(outer);
+    out() << "a";
+    {
+      Redirect second(inner);
+      out() << "b";
+      thread([&] { CHECK(&out() == &cout); }).join();
+    }
+    out() << "c";
+  }
+  CHECK(outer.str() == "ac");
+  CHECK(inner.str() == "b");
+}
+
+TEST(sink_buffered_holds_output_until_a_boundary) {
+  ostringstream target;
+  {
+    BufferedSink buffered(target.rdbuf(), 16);
+    ostream to(&buffered);
+    to << "0123456789";
+    CHECK(target.str().empty());  // Under the threshold, not flushed.
+    to << "abcdefghij";
+    CHECK(target.str() == "0123456789abcdef");  // Threshold reached.
+    to << endl;
+    CHECK(target.str() == "0123456789abcdefghij\n");
+    to << "tail";
+  }
+  CHECK(target.str() == "0123456789abcdefghij\ntail");  // Destructor.
+}
+
+TEST(sink_null_discards_any_volume) {
+  NullSink discard;
+  ostream to(&discard);
+  for (int i = 0; i < 10000; i++) to << "The hard way." << i << endl;
+  CHECK(to.good());
+}
+
+}  // sinkTest
+
+#endif /* TEST_SINKTEST_H_ */
@@ -0,0 +1,282 @@
+/*
+ * strategyBench.h
+ *
+ * Desc: Benchmarks for the strategy solution.
+ */
+
+#ifndef TEST_STRATEGYBENCH_H_
+#define TEST_STRATEGYBENCH_H_
+
+namespace strategyBench {
+
+using namespace homework::strategy::solution;
+
+WayBase* allocateWay(Way criteria) {  // The demo's original per-call path.
+  if (criteria == Hard)
+    return new HardWay;
+  else if (criteria == Easy)
+    return new EasyWay;
+  else if (criteria == Quick)
+    return new QuickWay;
+  else if (criteria == Clear)
+    return new ClearWay;
+  return new WayBase;
+}
+
+/* Dispatch through the fixed four-way registry, against building and
+ * freeing a way per dispatch.
+ */
+BENCH(strategy_registry) {
+  const size_t calls = 1000000;
+  double allocating = nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) {
+      WayBase* my = allocateWay(Way(i % WayCount));
+      my->way();
+      delete my;
+    }
+  });
+  double registry = nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) {
+      lookup(Way(i % WayCount))->way();
+    }
+  });
+
+  result("new/delete per call", allocating, "ns/call");
+  result("registry", registry, "ns/call");
+}
+
+/* ns/call through WayBase*, through the final class and through the
+ * closed-set WayVariant.
+ */
+BENCH(strategy_static_dispatch) {
+  const size_t calls = 2000000;
+  WayBase* base = lookup(Quick);
+  QuickWay* quick = static_cast<QuickWay*>(lookup(Quick));
+  WayVariant variant(Quick);
+
+  result("virtual", nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) clientCode1(base);
+  }), "ns/call");
+  result("final (static)", nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) clientCode1(quick);
+  }), "ns/call");
+  result("variant", nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) clientCode1(&variant);
+  }), "ns/call");
+}
+
+struct Compute {  // The work item: one way() call.
+  void operator()(size_t, WayBase* my) {
+    my->way();
+  }
+};
+
+void perfLine(const string& what, const PerfCounters& perf, size_t items) {
+  result(what + ", instructions", perf.perItem(PerfCounters::Instructions,
+                                               items), "per item");
+  result(what + ", branch misses", perf.perItem(PerfCounters::BranchMisses,
+                                                items), "per item");
+}
+
+/* A random mix of ways dispatched in array order against grouped by way.
+ * Counters read -1 where perf events are unavailable.
+ */
+BENCH(strategy_batch) {
+  const size_t items = 1000000;
+  vector<Way> criteria(items);
+  unsigned seed = 12345;
+  for (size_t i = 0; i < items; i++) {
+    seed = seed * 1103515245 + 12345;
+    criteria[i] = Way((seed >> 16) % WayCount);
+  }
+
+  PerfCounters perf;
+  perf.start();
+  double mixed = nsPerOp(items, [&] {
+    for (size_t i = 0; i < items; i++) lookup(criteria[i])->way();
+  });
+  perf.stop();
+  result("mixed order", mixed, "ns/item");
+  perfLine("mixed order", perf, items);
+
+  WayBatch grouped;
+  grouped.run(&criteria[0], items, Compute());  // Warm the index buffer.
+  perf.start();
+  double batched = nsPerOp(items, [&] {
+    grouped.run(&criteria[0], items, Compute());
+  });
+  perf.stop();
+  result("grouped by way", batched, "ns/item");
+  perfLine("grouped by way", perf, items);
+}
+
+struct Call {
+  void operator()(WayBase* my) {
+    my->way();
+  }
+};
+
+BENCH(strategy_selector) {  // Timing and bookkeeping cost per call.
+  const size_t calls = 1000000;
+  Way ways[] = {Hard, Easy, Quick};
+  WaySelector selector(ways, COUNT(ways));
+  WayBase* fixed = lookup(Quick);
+  result("fixed way", nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) fixed->way();
+  }), "ns/call");
+  result("selected way", nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) selector.run(Call());
+  }), "ns/call");
+}
+
+/* Read throughput through a WayHandle with and without a writer swapping
+ * it every microsecond, against a plain pointer.
+ */
+BENCH(strategy_handle) {
+  const size_t calls = 10000000;
+  WayBase* plain = lookup(Quick);
+  WayHandle handle(Quick);
+  result("plain pointer", nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) plain->way();
+  }), "ns/call");
+  result("handle, no swaps", nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) handle->way();
+  }), "ns/call");
+
+  atomic<bool> stop(false);
+  thread swapper([&] {
+    for (size_t i = 0; !stop.load(); i++) {
+      handle.swap(i % 2 ? Easy : Quick);
+      this_thread::sleep_for(chrono::microseconds(1));
+    }
+  });
+  result("handle, swapping", nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) handle->way();
+  }), "ns/call");
+  stop = true;
+  swapper.join();
+}
+
+BENCH(strategy_race) {  // Fixed cost of one race of three plain ways.
+  const size_t races = 10000;
+  Way ways[] = {Hard, Easy, Quick};
+  Race race(COUNT(ways));
+  result("race of 3", nsPerOp(races, [&] {
+    for (size_t i = 0; i < races; i++) race.run(ways, COUNT(ways));
+  }) * 1e-3, "us/race");
+}
+
+template <class Table>
+void clientTable(const string& what, const vector<uint32_t>& ids,
+                 Table& table) {
+  size_t before = allocationBytes();
+  double insert = nsPerOp(ids.size(), [&] {
+    for (size_t i = 0; i < ids.size(); i++) table[ids[i]] = Way(i % 4);
+  });
+  double bytes = double(allocationBytes() - before) / ids.size();
+  double find = nsPerOp(ids.size(), [&] {
+    size_t found = 0;
+    for (size_t i = 0; i < ids.size(); i++) found += table.count(ids[i]);
+    keep(found);
+  });
+  result(what + ", insert", insert, "ns/id");
+  result(what + ", find", find, "ns/id");
+  result(what + ", allocated", bytes, "bytes/id");
+}
+
+struct FlatTable {  // ClientWays behind the std::map calls used above.
+  ClientWays ways;
+  struct Slot {
+    FlatTable* table;
+    uint32_t id;
+    void operator=(Way way) {
+      table->ways.assign(id, way);
+    }
+  };
+  Slot operator[](uint32_t id) {
+    Slot slot = {this, id};
+    return slot;
+  }
+  size_t count(uint32_t id) const {
+    Way way;
+    return ways.find(id, way) ? 1 : 0;
+  }
+};
+
+/* A million client ids, random and strided (multiples of 2^16), through
+ * ClientWays, std::unordered_map and std::map. Allocated bytes include
+ * the growth that was thrown away along the way.
+ */
+BENCH(strategy_client_ways) {
+  const size_t clients = 1000000;
+  vector<uint32_t> random(clients), strided(clients);
+  unsigned seed = 2017;
+  for (size_t i = 0; i < clients; i++) {
+    seed = seed * 1103515245 + 12345;
+    random[i] = (seed ^ (seed >> 15)) & 0x7FFFFFFFu;
+    strided[i] = uint32_t(i << 16 | i >> 16);
+  }
+  {
+    FlatTable flat;
+    clientTable("ClientWays, random", random, flat);
+    result("ClientWays, held", double(flat.ways.bytes()) / clients,
+           "bytes/id");
+  }
+  {
+    FlatTable flat;
+    clientTable("ClientWays, strided", strided, flat);
+  }
+  {
+    unordered_map<uint32_t, Way> hashed;
+    clientTable("unordered_map, random", random, hashed);
+  }
+  {
+    map<uint32_t, Way> ordered;
+    clientTable("map, random", random, ordered);
+  }
+}
+
+struct Nothing {
+  void operator()() {
+  }
+};
+
+BENCH(strategy_profiler) {  // Cost per profiled call by sampling rate.
+  const size_t calls = 1000000;
+  unsigned long every[] = {1, 16, 1024};
+  result("disabled", nsPerOp(calls, [&] {
+    for (size_t i = 0; i < calls; i++) profiler().call(Easy, Nothing());
+  }), "ns/call");
+  for (size_t e = 0; e < COUNT(every); e++) {
+    profiler().enable(every[e]);
+    result("1 in " + to_string(every[e]) + " timed", nsPerOp(calls, [&] {
+      for (size_t i = 0; i < calls; i++) profiler().call(Easy, Nothing());
+    }), "ns/call");
+    profiler().disable();
+  }
+  profiler().reset();
+}
+
+/* fanOut over a criteria x client matrix of N rows (HW_FANOUT_ROWS,
+ * default 100,000) by worker count, in cells per second.
+ */
+BENCH(strategy_fan_out) {
+  const size_t rows = benchSize("HW_FANOUT_ROWS", 100000);
+  vector<Way> criteria(rows);
+  for (size_t i = 0; i < rows; i++) criteria[i] = Way(i % WayCount);
+  const size_t cells = rows * COUNT(clients);
+
+  vector<unsigned> workers = {1, 2, 4, 8, thread::hardware_concurrency()};
+  for (size_t w = 0; w < workers.size(); w++) {
+    if (!workers[w]) continue;  // Unknown hardware concurrency.
+    WorkStealingPool pool(workers[w]);
+    double ns = nsPerOp(cells, [&] { fanOut(&criteria[0], rows, pool); });
+    string label = to_string(workers[w]) + " workers";
+    if (w == workers.size() - 1) label += " (hardware)";
+    result(label, 1e9 / ns, "cells/sec");
+  }
+}
+
+}  // strategyBench
+
+#endif /* TEST_STRATEGYBENCH_H_ */
@@ -0,0 +1,304 @@
+/*
+ * strategyTest.h
+ *
+ * Desc: Tests for the strategy solution (homework::strategy::solution).
+ */
+
+#ifndef TEST_STRATEGYTEST_H_
+#define TEST_STRATEGYTEST_H_
+
+namespace strategyTest {
+
+using namespace homework::strategy::solution;
+
+TEST(strategy_registry_hands_out_shared_ways) {
+  CHECK(lookup(Hard) == lookup(Hard));
+  CHECK(dynamic_cast<HardWay*>(lookup(Hard)) != 0);
+  CHECK(dynamic_cast<EasyWay*>(lookup(Easy)) != 0);
+  CHECK(dynamic_cast<QuickWay*>(lookup(Quick)) != 0);
+  CHECK(dynamic_cast<ClearWay*>(lookup(Clear)) != 0);
+}
+
+TEST(strategy_registry_falls_back_for_unknown_ways) {
+  WayBase* oops = lookup(Way(99));
+  CHECK(oops != 0);
+  CHECK(typeid(*oops) == typeid(WayBase));
+}
+
+TEST(strategy_registry_dispatch_allocates_nothing) {
+  Way criteria[] = {Hard, Easy, Quick, Clear};
+  lookup(Hard);  // First use builds the registry.
+  AllocationScope scope;
+  for (size_t i = 0; i < 1000; i++) lookup(criteria[i % COUNT(criteria)]);
+  CHECK(scope.allocations() == 0);
+}
+
+template <class W>
+string captureClient(W* my) {
+  ostringstream captured;
+  Redirect redirect(captured);
+  clientCode1(my);
+  return captured.str();
+}
+
+TEST(strategy_static_and_variant_dispatch_match_virtual) {
+  Way criteria[] = {Hard, Easy, Quick, Clear};
+  for (size_t i = 0; i < COUNT(criteria); i++) {
+    WayVariant variant(criteria[i]);
+    CHECK(captureClient(&variant) == captureClient(lookup(criteria[i])));
+  }
+  HardWay* hard = static_cast<HardWay*>(lookup(Hard));
+  CHECK(captureClient(hard) == "  clientCode1 - The hard way.\n");
+}
+
+struct Record {
+  vector<pair<size_t, WayBase*> >* calls;
+  void operator()(size_t item, WayBase* my) {
+    calls->push_back(make_pair(item, my));
+  }
+};
+
+TEST(strategy_batch_groups_by_way_in_order) {
+  Way criteria[] = {Quick, Hard, Way(7), Quick, Easy, Hard};
+  vector<pair<size_t, WayBase*> > calls;
+  Record record = {&calls};
+  batch(criteria, COUNT(criteria), record);
+
+  size_t expected[] = {1, 5, 4, 0, 3, 2};  // Hard, Easy, Quick, unknown.
+  CHECK(calls.size() == COUNT(expected));
+  for (size_t i = 0; i < calls.size() && i < COUNT(expected); i++) {
+    CHECK(calls[i].first == expected[i]);
+    CHECK(calls[i].second == lookup(criteria[expected[i]]));
+  }
+}
+
+TEST(strategy_batch_reuse_allocates_nothing) {
+  vector<Way> criteria(1000);
+  for (size_t i = 0; i < criteria.size(); i++) criteria[i] = Way(i * 7 % 4);
+  vector<pair<size_t, WayBase*> > calls;
+  calls.reserve(criteria.size());
+  Record record = {&calls};
+  WayBatch grouped;
+  grouped.run(&criteria[0], criteria.size(), record);
+
+  calls.clear();
+  AllocationScope scope;
+  grouped.run(&criteria[0], criteria.size(), record);
+  CHECK(scope.allocations() == 0);
+  CHECK(calls.size() == criteria.size());
+}
+
+struct SlowOn {  // Busy-waits for ns when handed the slow way.
+  WayBase* slow;
+  long ns;
+  void operator()(WayBase* my) {
+    if (my != slow) return;
+    chrono::steady_clock::time_point end =
+        chrono::steady_clock::now() + chrono::nanoseconds(ns);
+    while (chrono::steady_clock::now() < end) {
+    }
+  }
+};
+
+TEST(strategy_selector_converges_on_the_fastest_way) {
+  Way ways[] = {Hard, Easy, Quick};
+  WaySelector selector(ways, COUNT(ways), 8);
+  SlowOn client = {lookup(Hard), 50000};
+  for (size_t i = 0; i < 200; i++) selector.run(client);
+  CHECK(selector.best() != Hard);
+  CHECK(selector.ewma(0) > selector.ewma(1));
+  CHECK(selector.p99(0) >= 32768);  // 50us lands at or above 2^15 ns.
+
+  client.slow = lookup(Easy);  // The fast way turns slow; exploring notices.
+  for (size_t i = 0; i < 400; i++) selector.run(client);
+  CHECK(selector.best() != Easy);
+}
+
+/* 16 readers call through the handle while a writer swaps it. Every read
+ * must see one of the registry's ways, never a torn or stale pointer.
+ */
+TEST(strategy_handle_swaps_under_concurrent_readers) {
+  Way ways[] = {Hard, Easy, Quick};
+  WayHandle handle(Hard);
+  atomic<bool> stop(false);
+  atomic<unsigned long> bad(0), reads(0), started(0);
+
+  vector<thread> readers;
+  for (int r = 0; r < 16; r++) {
+    readers.push_back(thread([&] {
+      NullSink discard;
+      ostream sink(&discard);
+      Redirect redirect(sink);
+      started++;
+      unsigned long n = 0;
+      while (!stop.load()) {
+        WayBase* my = handle.get();
+        if (my != lookup(Hard) && my != lookup(Easy) && my != lookup(Quick)) {
+          bad++;
+        }
+        my->way();
+        n++;
+      }
+      reads += n;
+    }));
+  }
+  while (started < readers.size()) this_thread::yield();
+  for (size_t i = 0; i < 20000; i++) handle.swap(ways[i % COUNT(ways)]);
+  stop = true;
+  for (size_t r = 0; r < readers.size(); r++) readers[r].join();
+
+  CHECK(bad == 0);
+  CHECK(reads > 0);
+  CHECK(handle.get() == lookup(ways[(20000 - 1) % COUNT(ways)]));
+}
+
+struct Sprint {  // Quick wins at once; the others wait to be cancelled.
+  mutex* lock;
+  set<thread::id>* threads;
+  bool operator()(WayBase* my, const CancelToken& token) {
+    {
+      lock_guard<mutex> guard(*lock);
+      threads->insert(this_thread::get_id());
+    }
+    if (my == lookup(Quick)) return my->cancellableWay(token);
+    while (!token.cancelled()) this_thread::yield();
+    return my->cancellableWay(token);
+  }
+};
+
+TEST(strategy_race_cancels_losers_on_pooled_threads) {
+  Way ways[] = {Hard, Easy, Quick};
+  Race race(COUNT(ways));
+  mutex lock;
+  set<thread::id> threads;
+  Sprint sprint = {&lock, &threads};
+  for (int i = 0; i < 50; i++) {
+    CHECK(race.run(ways, COUNT(ways), sprint) == Quick);
+  }
+  CHECK(race.total() == 50);
+  CHECK(race.winsFor(Quick) == 50);
+  CHECK(race.winsFor(Hard) == 0);
+  CHECK(threads.size() <= COUNT(ways));  // Reused, not one per contender.
+}
+
+TEST(strategy_race_counts_concurrent_races) {
+  Way ways[] = {Hard, Easy};
+  Race race(COUNT(ways));
+  vector<thread> callers;
+  for (int t = 0; t < 4; t++) {
+    callers.push_back(thread([&] {
+      NullSink discard;
+      ostream sink(&discard);
+      Redirect redirect(sink);
+      for (int i = 0; i < 25; i++) race.run(ways, COUNT(ways));
+    }));
+  }
+  for (size_t t = 0; t < callers.size(); t++) callers[t].join();
+  CHECK(race.total() == 100);
+  CHECK(race.winsFor(Hard) + race.winsFor(Easy) == 100);
+}
+
+string fanOutWith(unsigned workers) {
+  Way criteria[] = {Hard, Easy, Quick, Clear, Way(9)};
+  WorkStealingPool pool(workers);
+  ostringstream captured;
+  Redirect redirect(captured);
+  fanOut(criteria, COUNT(criteria), pool);
+  return captured.str();
+}
+
+TEST(strategy_fan_out_follows_redirect_in_order) {
+  string serial = fanOutWith(1);
+  CHECK(!serial.empty());
+  CHECK(fanOutWith(4) == serial);
+  CHECK(fanOutWith(16) == serial);
+}
+
+TEST(strategy_client_ways_finds_strided_ids) {
+  ClientWays assigned;
+  for (uint32_t i = 0; i < 20000; i++) assigned.assign(i << 16, Way(i % 4));
+  CHECK(assigned.size() == 20000);
+  bool all = true;
+  for (uint32_t i = 0; i < 20000; i++) {
+    Way way;
+    all = all && assigned.find(i << 16, way) && way == Way(i % 4);
+  }
+  CHECK(all);
+  Way way;
+  CHECK(!assigned.find(7, way));
+  CHECK(assigned.lookup(7, Easy) == lookup(Easy));
+}
+
+TEST(strategy_client_ways_reassign_in_place_keeps_capacity) {
+  vector<uint32_t> ids(1000);
+  vector<Way> ways(ids.size(), Hard);
+  for (size_t i = 0; i < ids.size(); i++) ids[i] = uint32_t(i * 7919);
+  ClientWays assigned;
+  assigned.bulkLoad(&ids[0], &ways[0], ids.size());
+  size_t bytes = assigned.bytes();
+
+  assigned.reassign(&ids[0], ids.size(), Quick);
+  CHECK(assigned.bytes() == bytes);
+  CHECK(assigned.size() == ids.size());
+  Way way;
+  CHECK(assigned.find(ids[500], way) && way == Quick);
+}
+
+TEST(strategy_client_ways_update_at_the_threshold_keeps_capacity) {
+  ClientWays assigned;
+  size_t bytes = assigned.bytes();
+  uint32_t half = uint32_t(bytes / (sizeof(uint32_t) + sizeof(uint8_t)) / 2);
+  for (uint32_t i = 0; i < half; i++) assigned.assign(i * 7919, Hard);
+  CHECK(assigned.bytes() == bytes);  // Exactly at the load threshold.
+
+  for (uint32_t i = 0; i < half; i++) assigned.assign(i * 7919, Clear);
+  CHECK(assigned.bytes() == bytes);
+  CHECK(assigned.size() == half);
+  Way way;
+  CHECK(assigned.find(7 * 7919, way) && way == Clear);
+}
+
+struct Spin {  // A call that takes ns.
+  long ns;
+  void operator()() {
+    chrono::steady_clock::time_point end =
+        chrono::steady_clock::now() + chrono::nanoseconds(ns);
+    while (chrono::steady_clock::now() < end) {
+    }
+  }
+};
+
+TEST(strategy_profiler_buckets_within_an_eighth) {
+  profiler().reset();
+  profiler().enable();
+  Spin spin = {100000};
+  for (int i = 0; i < 20; i++) profiler().call(Hard, spin);
+  for (int i = 0; i < 30; i++) profiler().call(Way(42), Spin());
+  profiler().disable();
+
+  CHECK(profiler().calls(Hard) == 20);
+  CHECK(profiler().calls(Way(77)) == 30);  // Unknown ways share a row.
+  unsigned long long p50 = profiler().percentile(Hard, 50);
+  CHECK(p50 >= 100000);
+  CHECK(p50 < 100000 * 9 / 8 + 20000);  // One bucket, plus timer slack.
+  profiler().reset();
+}
+
+TEST(strategy_profiler_reuses_tables_of_finished_threads) {
+  profiler().reset();
+  profiler().enable();
+  profiler().call(Easy, Spin());  // This thread's table.
+  size_t before = profiler().tableCount();
+  for (int t = 0; t < 50; t++) {
+    thread([] { profiler().call(Easy, Spin()); }).join();
+  }
+  profiler().disable();
+
+  CHECK(profiler().tableCount() <= before + 1);
+  CHECK(profiler().calls(Easy) == 51);  // Counts survive the threads.
+  profiler().reset();
+}
+
+}  // strategyTest
+
+#endif /* TEST_STRATEGYTEST_H_ */
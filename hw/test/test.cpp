@@ -0,0 +1,19 @@
+#include <cstddef>
+#include <ctime>
+#include <typeinfo>
+
+#include "homework.h"
+
+#include "test/allocations.h"
+#include "test/check.h"
+#include "test/scratch.h"
+
+#include "test/sinkTest.h"
+#include "test/strategyTest.h"
+#include "test/adapterTest.h"
+#include "test/factoryMethodTest.h"
+// Seam point - include the next pattern's tests.
+
+int main(int argc, char* args[]) {
+  return runTests(argc > 1 ? args[1] : "");
+}